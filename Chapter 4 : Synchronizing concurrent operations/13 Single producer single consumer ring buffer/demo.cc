@@ -0,0 +1,144 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * data_preparation_thread hands 10 million chunks to data_processing_thread, as in ../1, in three ways :
+ * 1. std::mutex + std::queue + std::condition_variable, exactly as ../1 does it,
+ * 2. spsc_ring, one push() and one wait_and_pop() per chunk,
+ * 3. spsc_ring, push_range() of 64 chunks at a time and wait_and_consume() of whatever is ready.
+ * A chunk is a sequence number, the consumer checks they arrive in order. It prints millions of
+ * chunks per second and the speedup over the condition variable.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "spsc_ring.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+typedef std::uint64_t data_chunk;
+
+struct condvar_queue
+{
+	std::mutex mut;
+	std::queue<data_chunk> data_queue;
+	std::condition_variable data_cond;
+};
+
+/* Runs producer and consumer on two threads and returns millions of chunks per second */
+template<typename Producer, typename Consumer>
+double chunks_per_us(unsigned long count, Producer producer, Consumer consumer)
+{
+	clock_type::time_point const start = clock_type::now();
+	std::thread t1(producer);
+	std::thread t2(consumer);
+	t1.join();
+	t2.join();
+	clock_type::time_point const stop = clock_type::now();
+	return count / std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+void check(bool in_order, char const* what)
+{
+	if( !in_order )
+	{
+		std::cout << what << " : CHUNKS OUT OF ORDER" << std::endl;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const count = argc > 1 ? std::atol(argv[1]) : 10000000;
+	std::size_t const batch = 64;
+
+	condvar_queue q;
+	bool in_order = true;
+	double const condvar = chunks_per_us(count,
+		[&q, count]
+		{
+			for( data_chunk i = 0 ; i < count ; i++ )
+			{
+				std::lock_guard<std::mutex> lk(q.mut);
+				q.data_queue.push(i);
+				q.data_cond.notify_one();
+			}
+		},
+		[&q, &in_order, count]
+		{
+			for( data_chunk expected = 0 ; expected < count ; expected++ )
+			{
+				std::unique_lock<std::mutex> lk(q.mut);
+				q.data_cond.wait(lk, [&q] { return !q.data_queue.empty(); });
+				data_chunk const data = q.data_queue.front();
+				q.data_queue.pop();
+				lk.unlock();
+				in_order = in_order && data == expected;
+			}
+		});
+	check(in_order, "condition variable");
+
+	spsc_ring<data_chunk> ring(1024);
+	double const single = chunks_per_us(count,
+		[&ring, count]
+		{
+			for( data_chunk i = 0 ; i < count ; i++ )
+			{
+				ring.push(i);
+			}
+		},
+		[&ring, &in_order, count]
+		{
+			data_chunk data;
+			for( data_chunk expected = 0 ; expected < count ; expected++ )
+			{
+				ring.wait_and_pop(data);
+				in_order = in_order && data == expected;
+			}
+		});
+	check(in_order, "spsc_ring");
+
+	double const batched = chunks_per_us(count,
+		[&ring, count, batch]
+		{
+			std::vector<data_chunk> chunks(batch);
+			for( data_chunk i = 0 ; i < count ; )
+			{
+				std::size_t n = 0;
+				for( ; n < batch && i < count ; n++, i++ )
+				{
+					chunks[n] = i;
+				}
+				ring.push_range(chunks.begin(), chunks.begin() + n);
+			}
+		},
+		[&ring, &in_order, count]
+		{
+			data_chunk expected = 0;
+			while( expected < count )
+			{
+				ring.wait_and_consume([&in_order, &expected](data_chunk& data)
+				{
+					in_order = in_order && data == expected;
+					expected++;
+				});
+			}
+		});
+	check(in_order, "spsc_ring batched");
+
+	std::cout << "cores : " << std::thread::hardware_concurrency() << ", " << count << " chunks" << std::endl;
+	std::cout << "mutex + condition variable : " << condvar << " M/s" << std::endl;
+	std::cout << "spsc_ring, one at a time : " << single << " M/s (" << single / condvar << "x)" << std::endl;
+	std::cout << "spsc_ring, batches of " << batch << " : " << batched << " M/s (" << batched / condvar << "x)" << std::endl;
+	return 0;
+}
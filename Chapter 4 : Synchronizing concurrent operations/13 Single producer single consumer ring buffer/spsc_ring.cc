@@ -0,0 +1,340 @@
+/*
+ * spsc_ring.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+In ../1 every chunk handed from data_preparation_thread to data_processing_thread costs a lock of
+mut, a push on a std::queue (which allocates as it grows) and a notify_one(). The consumer takes
+the same lock for every pop. With exactly one producer and one consumer none of that is needed :
+
+1. The ring is a fixed array. tail is written only by the producer and head only by the
+   consumer, so each index is a plain store, with no compare-exchange and no lock. try_push()
+   and try_pop() finish in a bounded number of steps whatever the other thread does (wait-free).
+2. Each side keeps a cached copy of the other side's index and only reloads it when the cache says
+   the ring is full (producer) or empty (consumer). Most operations touch no cache line the
+   other thread writes except the slot itself.
+3. tail with the producer's cache, head with the consumer's cache, and the two waiting flags
+   below each sit on their own cache line, so the threads do not steal each other's lines on
+   every operation.
+4. push_range() and consume() move a whole batch and publish it with a single index store.
+5. push() and wait_and_pop() block only when the ring is full or empty. They spin a little, then
+   set a waiting flag and sleep on it with std::atomic<>::wait() (a futex on Linux). The other
+   side checks the flag after each publish and pays for a wake only when someone is asleep.
+   The fence that makes this safe is paid by the side going to sleep (asymmetric_fence).
+
+Only one thread may call the producer functions and only one the consumer functions.
+ */
+#ifndef SPSC_RING_CC
+#define SPSC_RING_CC
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * A store followed by a load of another variable needs a full fence on both sides (see wake() and
+ * sleep_until() below). One side runs on every push and pop, the other only before going to sleep.
+ * On Linux membarrier() lets the rare side pay for both : it runs a full barrier on every running
+ * thread of the process, so the frequent side only has to stop the compiler from reordering.
+ * Elsewhere, or if the kernel lacks it, both sides use an ordinary fence.
+ */
+class asymmetric_fence
+{
+	static bool expedited()
+	{
+#ifdef __linux__
+		static bool const registered = syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+		return registered;
+#else
+		return false;
+#endif
+	}
+
+public:
+	static void light()
+	{
+		if( expedited() )
+		{
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+		}
+		else
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	static void heavy()
+	{
+#ifdef __linux__
+		if( expedited() )
+		{
+			syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+			return;
+		}
+#endif
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+};
+
+template<typename T>
+class spsc_ring
+{
+	static constexpr std::size_t cache_line_size = 64;
+
+	struct slot
+	{
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		T* value()
+		{
+			return std::launder(reinterpret_cast<T*>(storage));
+		}
+	};
+
+	std::size_t const mask;
+	std::unique_ptr<slot[]> slots;
+
+	/* Producer's line */
+	alignas(cache_line_size) std::atomic<std::size_t> tail;		// next slot to fill
+	std::size_t cached_head;
+
+	/* Consumer's line */
+	alignas(cache_line_size) std::atomic<std::size_t> head;		// next slot to read
+	std::size_t cached_tail;
+
+	/* Read after every publish but written only around a sleep, so kept off both lines above */
+	alignas(cache_line_size) std::atomic<std::uint32_t> producer_waiting;
+	std::atomic<std::uint32_t> consumer_waiting;
+
+	static std::size_t round_up(std::size_t capacity)
+	{
+		std::size_t size = 2;
+		while( size < capacity )
+		{
+			size <<= 1;
+		}
+		return size;
+	}
+
+	/* Room for up to wanted more values, reloading head only if the cache says we are short */
+	std::size_t free_slots(std::size_t t, std::size_t wanted)
+	{
+		std::size_t room = mask + 1 - (t - cached_head);
+		if( room < wanted )
+		{
+			cached_head = head.load(std::memory_order_acquire);
+			room = mask + 1 - (t - cached_head);
+		}
+		return room;
+	}
+
+	/* Values ready to read, reloading tail only if the cache says there are none */
+	std::size_t ready_slots(std::size_t h)
+	{
+		if( cached_tail == h )
+		{
+			cached_tail = tail.load(std::memory_order_acquire);
+		}
+		return cached_tail - h;
+	}
+
+	/* After publishing : wake the other side if it went to sleep. The fence pairs with the one in sleep_until() */
+	static void wake(std::atomic<std::uint32_t>& waiting)
+	{
+		asymmetric_fence::light();
+		if( waiting.load(std::memory_order_relaxed) )
+		{
+			waiting.store(0, std::memory_order_relaxed);
+			waiting.notify_one();
+		}
+	}
+
+	/*
+	 * Spin, then sleep until ready() holds. The flag is raised before the last check, so a publish that
+	 * the check missed is guaranteed to see the flag and wake us.
+	 */
+	template<typename Predicate>
+	static void sleep_until(std::atomic<std::uint32_t>& waiting, Predicate ready)
+	{
+		for( unsigned spins = 0 ; spins < 64 ; spins++ )
+		{
+			if( ready() )
+			{
+				return;
+			}
+			std::this_thread::yield();
+		}
+		while( !ready() )
+		{
+			waiting.store(1, std::memory_order_relaxed);
+			asymmetric_fence::heavy();
+			if( ready() )
+			{
+				waiting.store(0, std::memory_order_relaxed);
+				return;
+			}
+			waiting.wait(1, std::memory_order_relaxed);
+		}
+	}
+
+public:
+	/* capacity is rounded up to a power of two */
+	explicit spsc_ring(std::size_t capacity = 1024) :
+		mask(round_up(capacity) - 1), slots(new slot[mask + 1]),
+		tail(0), cached_head(0), head(0), cached_tail(0),
+		producer_waiting(0), consumer_waiting(0)
+	{}
+
+	spsc_ring(const spsc_ring&) = delete;
+	spsc_ring& operator = (const spsc_ring&) = delete;
+
+	/* No other thread may be using the ring */
+	~spsc_ring()
+	{
+		std::size_t const t = tail.load(std::memory_order_relaxed);
+		for( std::size_t h = head.load(std::memory_order_relaxed) ; h != t ; h++ )
+		{
+			slots[h & mask].value()->~T();
+		}
+	}
+
+	/* Producer : false if the ring is full, value is moved from only on success */
+	template<typename U>
+	bool try_push(U&& value)
+	{
+		std::size_t const t = tail.load(std::memory_order_relaxed);
+		if( !free_slots(t, 1) )
+		{
+			return false;
+		}
+		new (slots[t & mask].storage) T(std::forward<U>(value));
+		tail.store(t + 1, std::memory_order_release);
+		wake(consumer_waiting);
+		return true;
+	}
+
+	/* Producer : wait while the ring is full */
+	void push(T value)
+	{
+		if( try_push(std::move(value)) )
+		{
+			return;
+		}
+		sleep_until(producer_waiting, [this] { return free_slots(tail.load(std::memory_order_relaxed), 1) != 0; });
+		try_push(std::move(value));
+	}
+
+	/* Producer : move as much of [first, last) as fits, publish it with one store, return where it stopped */
+	template<typename Iterator>
+	Iterator try_push_range(Iterator first, Iterator last)
+	{
+		std::size_t const t = tail.load(std::memory_order_relaxed);
+		std::size_t const room = free_slots(t, mask + 1);
+		std::size_t n = 0;
+		for( ; first != last && n < room ; ++first, ++n )
+		{
+			new (slots[(t + n) & mask].storage) T(std::move(*first));
+		}
+		if( n )
+		{
+			tail.store(t + n, std::memory_order_release);
+			wake(consumer_waiting);
+		}
+		return first;
+	}
+
+	/* Producer : move all of [first, last), waiting whenever the ring is full */
+	template<typename Iterator>
+	void push_range(Iterator first, Iterator last)
+	{
+		while( (first = try_push_range(first, last)) != last )
+		{
+			sleep_until(producer_waiting, [this] { return free_slots(tail.load(std::memory_order_relaxed), 1) != 0; });
+		}
+	}
+
+	/* Consumer : false if the ring is empty */
+	bool try_pop(T& value)
+	{
+		std::size_t const h = head.load(std::memory_order_relaxed);
+		if( !ready_slots(h) )
+		{
+			return false;
+		}
+		T* const data = slots[h & mask].value();
+		value = std::move(*data);
+		data->~T();
+		head.store(h + 1, std::memory_order_release);
+		wake(producer_waiting);
+		return true;
+	}
+
+	/* Consumer : wait while the ring is empty */
+	void wait_and_pop(T& value)
+	{
+		while( !try_pop(value) )
+		{
+			sleep_until(consumer_waiting, [this] { return ready_slots(head.load(std::memory_order_relaxed)) != 0; });
+		}
+	}
+
+	/* Consumer : f(T&) on up to max ready values, freed with one store. Returns how many. f must not throw */
+	template<typename Function>
+	std::size_t consume(Function f, std::size_t max = std::size_t(-1))
+	{
+		std::size_t const h = head.load(std::memory_order_relaxed);
+		std::size_t const ready = ready_slots(h);
+		std::size_t const n = ready < max ? ready : max;
+		for( std::size_t i = 0 ; i < n ; i++ )
+		{
+			T* const data = slots[(h + i) & mask].value();
+			f(*data);
+			data->~T();
+		}
+		if( n )
+		{
+			head.store(h + n, std::memory_order_release);
+			wake(producer_waiting);
+		}
+		return n;
+	}
+
+	/* Consumer : as consume(), waiting until there is at least one value. Returns 0 at once if max is 0 */
+	template<typename Function>
+	std::size_t wait_and_consume(Function f, std::size_t max = std::size_t(-1))
+	{
+		if( max == 0 )
+		{
+			return 0;
+		}
+		std::size_t n;
+		while( !(n = consume(f, max)) )
+		{
+			sleep_until(consumer_waiting, [this] { return ready_slots(head.load(std::memory_order_relaxed)) != 0; });
+		}
+		return n;
+	}
+
+	/* Exact for the consumer, a snapshot for anyone else */
+	bool empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	std::size_t capacity() const
+	{
+		return mask + 1;
+	}
+};
+
+#endif /* SPSC_RING_CC */
@@ -16,6 +16,9 @@ interface looks like the following.
 #include <condition_variable>
 #include <queue>
 #include <memory>
+#include <cstddef>
+#include <exception>
+#include <vector>
 
 template<typename T>
 class threadsafe_queue
@@ -40,6 +43,44 @@ public:
 		data_cond.notify_one();
 	}
 
+	/*
+	 * Push a copy of every value of [first, last) under one lock, with one notify. Pass
+	 * std::move_iterator<>s to move the values instead. If a copy throws, the values before it stay
+	 * queued and waiting consumers are still woken for them
+	 */
+	template<typename Iterator>
+	void push_range(Iterator first, Iterator last)
+	{
+		std::size_t count = 0;
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lk(mut);
+			try
+			{
+				for( ; first != last ; ++first, ++count )
+				{
+					data_queue.push(*first);
+				}
+			}
+			catch(...)
+			{
+				error = std::current_exception();
+			}
+		}
+		if( count == 1 )
+		{
+			data_cond.notify_one();
+		}
+		else if( count > 1 )
+		{
+			data_cond.notify_all();
+		}
+		if( error )
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
 	void wait_and_pop(T &value)
 	{
 		std::unique_lock<std::mutex> lk(mut);
@@ -82,11 +123,42 @@ public:
 		{
 			return std::shared_ptr<T>();
 		}
-		std::shared_ptr<T> result(std::make_shared(data_queue.front));
+		std::shared_ptr<T> result(std::make_shared<T>(data_queue.front()));
 		data_queue.pop();
 		return result;
 	}
 
+	/* Pop up to max values into out under one lock, return how many */
+	template<typename OutputIterator>
+	std::size_t try_pop_bulk(OutputIterator out, std::size_t max)
+	{
+		std::lock_guard<std::mutex> lk(mut);
+		std::size_t count = 0;
+		for( ; count < max && !data_queue.empty() ; count++ )
+		{
+			*out++ = std::move(data_queue.front());
+			data_queue.pop();
+		}
+		return count;
+	}
+
+	/* Take the whole queue by swapping it for an empty one, the values are moved out after unlocking */
+	std::vector<T> pop_all()
+	{
+		std::queue<T> taken;
+		{
+			std::lock_guard<std::mutex> lk(mut);
+			taken.swap(data_queue);
+		}
+		std::vector<T> result;
+		result.reserve(taken.size());
+		for( ; !taken.empty() ; taken.pop() )
+		{
+			result.push_back(std::move(taken.front()));
+		}
+		return result;
+	}
+
 	bool empty() const
 	{
 		std::lock_guard<std::mutex> lk(mut);
@@ -0,0 +1,130 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Message passing through the threadsafe_queue of ../6 and through recycling_queue, with 1, 2 and 4
+ * producer/consumer pairs moving 4 million messages. A message is a small struct moved by value.
+ * The program replaces the global operator new to count allocations, and prints millions of
+ * messages per second and allocations per message. recycling_queue allocates only while its free
+ * lists fill up, so in steady state the count is close to zero.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+#include "recycling_queue.cc"
+#include "../6 Thread safe queue with locking and waiting/demo.cc"
+
+static std::atomic<unsigned long> allocations(0);
+
+void* operator new(std::size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if( void* const p = std::malloc(size ? size : 1) )
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+typedef std::chrono::steady_clock clock_type;
+
+struct message
+{
+	std::uint64_t sequence;
+	std::uint32_t kind;
+	std::uint32_t length;
+};
+
+struct result
+{
+	double messages_per_us;
+	double allocations_per_message;
+};
+
+template<typename Queue>
+result run(unsigned pairs, unsigned long total)
+{
+	unsigned long const per_pair = total / pairs;
+	Queue queue;
+	std::vector<std::thread> threads;
+	std::atomic<unsigned long> checksum(0);
+
+	unsigned long const allocations_before = allocations.load();
+	clock_type::time_point const start = clock_type::now();
+	for( unsigned p = 0 ; p < pairs ; p++ )
+	{
+		threads.push_back(std::thread([&queue, per_pair]
+		{
+			for( unsigned long i = 0 ; i < per_pair ; i++ )
+			{
+				queue.push(message{i, 1, 12});
+			}
+		}));
+		threads.push_back(std::thread([&queue, &checksum, per_pair]
+		{
+			unsigned long sum = 0;
+			message m;
+			for( unsigned long i = 0 ; i < per_pair ; i++ )
+			{
+				queue.wait_and_pop(m);
+				sum += m.sequence;
+			}
+			checksum.fetch_add(sum);
+		}));
+	}
+	for( unsigned long i = 0 ; i < threads.size() ; i++ )
+	{
+		threads[i].join();
+	}
+	clock_type::time_point const stop = clock_type::now();
+	unsigned long const allocated = allocations.load() - allocations_before;
+
+	if( checksum != pairs * (per_pair * (per_pair - 1) / 2) )
+	{
+		std::cout << "WRONG CHECKSUM" << std::endl;
+	}
+	result r;
+	r.messages_per_us = double(per_pair) * pairs / std::chrono::duration<double, std::micro>(stop - start).count();
+	r.allocations_per_message = double(allocated) / (per_pair * pairs);
+	return r;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const total = argc > 1 ? std::atol(argv[1]) : 4000000;
+	std::cout << "cores : " << std::thread::hardware_concurrency() << ", " << total << " messages" << std::endl;
+	std::cout << "pairs   threadsafe_queue (M/s, allocs/msg)   recycling_queue (M/s, allocs/msg)" << std::endl;
+	std::cout << std::fixed;
+	for( unsigned pairs = 1 ; pairs <= 4 ; pairs *= 2 )
+	{
+		result const a = run<threadsafe_queue<message>>(pairs, total);
+		result const b = run<recycling_queue<message>>(pairs, total);
+		std::cout << std::setw(5) << pairs
+				  << std::setprecision(2) << std::setw(14) << a.messages_per_us
+				  << std::setprecision(4) << std::setw(14) << a.allocations_per_message
+				  << std::setprecision(2) << std::setw(21) << b.messages_per_us
+				  << std::setprecision(4) << std::setw(14) << b.allocations_per_message << std::endl;
+	}
+	return 0;
+}
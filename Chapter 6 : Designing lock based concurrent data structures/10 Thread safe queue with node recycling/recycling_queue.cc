@@ -0,0 +1,449 @@
+/*
+ * recycling_queue.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+Every push() on the threadsafe_queue of ../5 and ../6 allocates twice, std::make_shared<T> for the value
+and new node for the next dummy, and every pop frees both again. Consumers get a std::shared_ptr<T>
+whose reference count is atomic, even though they are the only owner.
+
+recycling_queue keeps the two locks of ../6 (head_mutex for consumers, tail_mutex for producers) and
+the dummy node that keeps them apart, but :
+1. The value is stored inline in the node, so a push is one node and no separate allocation. It is
+   constructed before tail_mutex is taken. head is the dummy : the first value lives in head->next,
+   and popping it makes that node the new dummy.
+2. Values are handed out by move : try_pop(T&) and wait_and_pop(T&), or std::optional<T> try_pop()
+   and T wait_and_pop(). There is no std::shared_ptr<T>.
+3. Nodes are recycled. Popped nodes go onto a free list of the popping thread, and push() takes
+   nodes from the free list of the pushing thread. With separate producer and consumer threads,
+   nodes pile up on one side and run out on the other, so whole batches of nodes move through a
+   global overflow list, one lock per batch. In steady state nothing reaches the allocator.
+   A thread that exits hands its nodes to the overflow list. Nodes are never given back to the
+   allocator, so memory stays at the peak number of nodes in use. A queue destroyed after that,
+   from a later thread_local or static destructor, gives its nodes straight to the overflow list.
+4. In ../6 push() notifies without holding head_mutex, so a consumer that has just found the queue
+   empty but is not yet inside wait() can miss the notify. Here waiting consumers are counted,
+   and push() only notifies, after taking head_mutex, when the count is not zero.
+The free lists are shared by every recycling_queue<T> with the same T.
+ */
+#ifndef RECYCLING_QUEUE_CC
+#define RECYCLING_QUEUE_CC
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class recycling_queue
+{
+private:
+	struct node
+	{
+		node* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		T* value()
+		{
+			return std::launder(reinterpret_cast<T*>(storage));
+		}
+	};
+
+	/* Free nodes of one thread, and batches of them shared between threads */
+	class node_pool
+	{
+		static constexpr std::size_t batch_size = 128;
+
+		struct chain
+		{
+			node* first;
+			std::size_t count;
+		};
+
+		struct overflow_list
+		{
+			std::mutex mut;
+			std::vector<chain> chains;
+		};
+
+		/* Never destroyed : a thread may give its nodes back during static destruction */
+		static overflow_list& overflow()
+		{
+			static overflow_list* const list = new overflow_list;
+			return *list;
+		}
+
+		struct local_list;
+
+		/* Trivially destructible, so it can still be read from later thread_local and static destructors */
+		struct list_pointer
+		{
+			local_list* list;		// nullptr until first use, and again once torn down
+			bool torn_down;
+		};
+
+		static list_pointer& current()
+		{
+			static thread_local list_pointer pointer = { nullptr, false };
+			return pointer;
+		}
+
+		struct local_list
+		{
+			node* first;
+			std::size_t count;
+
+			local_list() : first(nullptr), count(0)
+			{
+				current().list = this;
+			}
+
+			~local_list()
+			{
+				current().list = nullptr;
+				current().torn_down = true;
+				if( first )
+				{
+					overflow_list& list = overflow();
+					std::lock_guard<std::mutex> lk(list.mut);
+					list.chains.push_back(chain{first, count});
+				}
+			}
+		};
+
+		/* The calling thread's free list, created on first use. nullptr once the thread has torn it down */
+		static local_list* local()
+		{
+			list_pointer& pointer = current();
+			if( !pointer.list && !pointer.torn_down )
+			{
+				static thread_local local_list list;
+			}
+			return pointer.list;
+		}
+
+		/* Without a free list of our own, one node at a time from the overflow list */
+		static node* get_shared()
+		{
+			{
+				overflow_list& list = overflow();
+				std::lock_guard<std::mutex> lk(list.mut);
+				if( !list.chains.empty() )
+				{
+					chain& c = list.chains.back();
+					node* const n = c.first;
+					c.first = n->next;
+					if( --c.count == 0 )
+					{
+						list.chains.pop_back();
+					}
+					return n;
+				}
+			}
+			return new node;
+		}
+
+		static void put_shared(node* n)
+		{
+			n->next = nullptr;
+			overflow_list& list = overflow();
+			std::lock_guard<std::mutex> lk(list.mut);
+			list.chains.push_back(chain{n, 1});
+		}
+
+	public:
+		static node* get()
+		{
+			local_list* const lp = local();
+			if( !lp )
+			{
+				return get_shared();
+			}
+			local_list& l = *lp;
+			if( !l.first )
+			{
+				overflow_list& list = overflow();
+				std::lock_guard<std::mutex> lk(list.mut);
+				if( !list.chains.empty() )
+				{
+					l.first = list.chains.back().first;
+					l.count = list.chains.back().count;
+					list.chains.pop_back();
+				}
+			}
+			if( !l.first )
+			{
+				return new node;
+			}
+
+			node* const n = l.first;
+			l.first = n->next;
+			l.count--;
+			return n;
+		}
+
+		/* Once a thread holds two batches, one of them goes to the overflow list */
+		static void put(node* n)
+		{
+			local_list* const lp = local();
+			if( !lp )
+			{
+				put_shared(n);
+				return;
+			}
+			local_list& l = *lp;
+			n->next = l.first;
+			l.first = n;
+			if( ++l.count < 2 * batch_size )
+			{
+				return;
+			}
+
+			node* last = l.first;
+			for( std::size_t i = 1 ; i < batch_size ; i++ )
+			{
+				last = last->next;
+			}
+			chain const spare = { l.first, batch_size };
+			l.first = last->next;
+			l.count -= batch_size;
+			last->next = nullptr;
+
+			overflow_list& list = overflow();
+			std::lock_guard<std::mutex> lk(list.mut);
+			list.chains.push_back(spare);
+		}
+	};
+
+	std::mutex head_mutex;
+	node* head;
+	std::mutex tail_mutex;
+	node* tail;
+	std::condition_variable data_cond;
+	std::atomic<unsigned> waiting_consumers;		// changed under head_mutex, read under tail_mutex
+
+	node* get_tail();
+	bool has_data();
+	void wait_for_data(std::unique_lock<std::mutex>& head_lock);
+	template<typename Receive>
+	node* pop_head(Receive receive);
+
+public:
+	recycling_queue() : head(node_pool::get()), tail(head), waiting_consumers(0)
+	{
+		head->next = nullptr;
+	}
+
+	~recycling_queue();
+
+	recycling_queue(const recycling_queue& other) = delete;
+	recycling_queue& operator= (const recycling_queue& other) = delete;
+
+	std::optional<T> try_pop();
+	bool try_pop(T& value);
+	T wait_and_pop();
+	void wait_and_pop(T& value);
+	void push(T new_value);
+	bool empty();
+};
+
+/*
+ * Destroy the values still queued and give every node, the dummy included, back to the free list
+ */
+template<typename T>
+recycling_queue<T>::~recycling_queue()
+{
+	node* n = head;
+	node* next = n->next;
+	node_pool::put(n);
+	for( n = next ; n ; n = next )
+	{
+		next = n->next;
+		n->value()->~T();
+		node_pool::put(n);
+	}
+}
+
+/*
+ * Get tail pointer of the queue
+ */
+template<typename T>
+typename recycling_queue<T>::node* recycling_queue<T>::get_tail()
+{
+	std::lock_guard<std::mutex> tail_lock(tail_mutex);
+	return tail;
+}
+
+/*
+ * With head_mutex held. Comparing against tail under tail_mutex, rather than reading head->next,
+ * also makes the producer's write of head->next visible to us
+ */
+template<typename T>
+bool recycling_queue<T>::has_data()
+{
+	return head != get_tail();
+}
+
+/*
+ * With head_mutex held. A waiting consumer is counted before it looks at tail, so a producer that
+ * moves tail after that look sees the count and wakes it
+ */
+template<typename T>
+void recycling_queue<T>::wait_for_data(std::unique_lock<std::mutex>& head_lock)
+{
+	if( has_data() )
+	{
+		return;
+	}
+	waiting_consumers.fetch_add(1, std::memory_order_relaxed);
+	while( !has_data() )
+	{
+		data_cond.wait(head_lock);
+	}
+	waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/*
+ * With head_mutex held and the queue not empty. Hands the first value to receive, makes its node the
+ * new dummy and returns the old dummy, to be recycled once head_mutex is released
+ */
+template<typename T>
+template<typename Receive>
+typename recycling_queue<T>::node* recycling_queue<T>::pop_head(Receive receive)
+{
+	node* const old_head = head;
+	node* const first = old_head->next;
+	T* const data = first->value();
+	receive(*data);
+	data->~T();
+	head = first;
+	return old_head;
+}
+
+/*
+ * Push new_value of type T into the queue. The node is taken and the value moved into it before
+ * tail_mutex is taken
+ */
+template<typename T>
+void recycling_queue<T>::push(T new_value)
+{
+	node* const p = node_pool::get();
+	p->next = nullptr;
+	try
+	{
+		new (p->storage) T(std::move(new_value));
+	}
+	catch(...)
+	{
+		node_pool::put(p);
+		throw;
+	}
+
+	bool wake;
+	{
+		std::lock_guard<std::mutex> tail_lock(tail_mutex);
+		tail->next = p;
+		tail = p;
+		wake = waiting_consumers.load(std::memory_order_relaxed) != 0;
+	}
+
+	/*
+	 * Only when a consumer is waiting. Taking head_mutex first means it has really gone to sleep in
+	 * wait() and cannot miss the notify
+	 */
+	if( wake )
+	{
+		{
+			std::lock_guard<std::mutex> head_lock(head_mutex);
+		}
+		data_cond.notify_one();
+	}
+}
+
+/*
+ * Non waiting pop. Return popped value in value parameter, true if popped and false if queue is empty
+ */
+template<typename T>
+bool recycling_queue<T>::try_pop(T& value)
+{
+	node* old_head;
+	{
+		std::lock_guard<std::mutex> head_lock(head_mutex);
+		if( !has_data() )
+		{
+			return false;
+		}
+		old_head = pop_head([&value](T& data) { value = std::move(data); });
+	}
+	node_pool::put(old_head);
+	return true;
+}
+
+/*
+ * Non waiting pop. Return the popped value, or an empty optional if queue is empty
+ */
+template<typename T>
+std::optional<T> recycling_queue<T>::try_pop()
+{
+	std::optional<T> result;
+	node* old_head;
+	{
+		std::lock_guard<std::mutex> head_lock(head_mutex);
+		if( !has_data() )
+		{
+			return result;
+		}
+		old_head = pop_head([&result](T& data) { result.emplace(std::move(data)); });
+	}
+	node_pool::put(old_head);
+	return result;
+}
+
+/*
+ * Wait for queue to be non-empty and then return popped data in value
+ */
+template<typename T>
+void recycling_queue<T>::wait_and_pop(T& value)
+{
+	node* old_head;
+	{
+		std::unique_lock<std::mutex> head_lock(head_mutex);
+		wait_for_data(head_lock);
+		old_head = pop_head([&value](T& data) { value = std::move(data); });
+	}
+	node_pool::put(old_head);
+}
+
+/*
+ * Wait for queue to be non-empty and then return the popped value
+ */
+template<typename T>
+T recycling_queue<T>::wait_and_pop()
+{
+	std::optional<T> result;
+	node* old_head;
+	{
+		std::unique_lock<std::mutex> head_lock(head_mutex);
+		wait_for_data(head_lock);
+		old_head = pop_head([&result](T& data) { result.emplace(std::move(data)); });
+	}
+	node_pool::put(old_head);
+	return std::move(*result);
+}
+
+/*
+ * Check if queue is empty
+ */
+template<typename T>
+bool recycling_queue<T>::empty()
+{
+	std::lock_guard<std::mutex> head_lock(head_mutex);
+	return !has_data();
+}
+
+#endif /* RECYCLING_QUEUE_CC */
@@ -5,9 +5,11 @@
  *      Author: prateek
  *      Pg 166
  */
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 template<typename T>
 class threadsafe_queue
@@ -32,6 +34,8 @@ private:
 	std::unique_ptr<node> wait_pop_head(T& value);
 	std::unique_ptr<node> try_pop_head();
 	std::unique_ptr<node> try_pop_head(T& value);
+	std::unique_ptr<node> try_pop_head_chain(std::size_t max);
+	static void free_chain(std::unique_ptr<node> chain);
 
 
 public:
@@ -46,6 +50,11 @@ public:
 	std::shared_ptr<T> wait_and_pop();
 	void wait_and_pop(T& value);
 	void push(T new_value);
+	template<typename Iterator>
+	void push_range(Iterator first, Iterator last);
+	template<typename OutputIterator>
+	std::size_t try_pop_bulk(OutputIterator out, std::size_t max);
+	std::vector<T> pop_all();
 	bool empty();
 
 };
@@ -69,11 +78,62 @@ void threadsafe_queue<T>::push(T new_value)
 	data_cond.notify_one();
 }
 
+/*
+ * Push a copy of every value of [first, last), like push_range() of the queue in Chapter 4/2. Pass
+ * std::move_iterator<>s to move the values instead. Every value is copied into its shared_ptr and the
+ * nodes are linked up before taking tail_mutex, so if a copy throws the queue is untouched, and the
+ * chain is spliced on under a single lock
+ */
+template<typename T>
+template<typename Iterator>
+void threadsafe_queue<T>::push_range(Iterator first, Iterator last)
+{
+	if( first == last )
+	{
+		return;
+	}
+
+	/* The first value goes into the current dummy tail, the others into new nodes ending in a new dummy */
+	std::shared_ptr<T> const first_data(std::make_shared<T>(*first));
+	std::unique_ptr<node> chain(new node);
+	node* chain_tail = chain.get();
+	std::size_t count = 1;
+	try
+	{
+		for( ++first ; first != last ; ++first, ++count )
+		{
+			chain_tail->data = std::make_shared<T>(*first);
+			chain_tail->next.reset(new node);
+			chain_tail = chain_tail->next.get();
+		}
+	}
+	catch(...)
+	{
+		free_chain(std::move(chain));
+		throw;
+	}
+	{
+		std::lock_guard<std::mutex> tail_lock(tail_mutex);
+		tail->data = first_data;
+		tail->next = std::move(chain);
+		tail = chain_tail;
+	}
+
+	if( count == 1 )
+	{
+		data_cond.notify_one();
+	}
+	else
+	{
+		data_cond.notify_all();
+	}
+}
+
 /*
  * Get tail pointer of the queue
  */
 template<typename T>
-threadsafe_queue::node* threadsafe_queue<T>::get_tail()
+typename threadsafe_queue<T>::node* threadsafe_queue<T>::get_tail()
 {
 	std::lock_guard<std::mutex> tail_lock(tail_mutex);
 	return tail;
@@ -83,9 +143,9 @@ threadsafe_queue::node* threadsafe_queue<T>::get_tail()
  * Pop head of the queue and return pointer to popped head node
  */
 template<typename T>
-std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::pop_head()
+std::unique_ptr<typename threadsafe_queue<T>::node> threadsafe_queue<T>::pop_head()
 {
-	std::unique_ptr<threadsafe_queue::node> const old_head = std::move(head);
+	std::unique_ptr<threadsafe_queue::node> old_head = std::move(head);
 	head = std::move(old_head->next);
 	return old_head;
 }
@@ -97,15 +157,15 @@ template<typename T>
 std::unique_lock<std::mutex> threadsafe_queue<T>::wait_for_data()
 {
 	std::unique_lock<std::mutex> head_lock(head_mutex);
-	data_cond.wait(head_lock, [&] { return head != get_tail() ;});
-	return std::move(head_lock);
+	data_cond.wait(head_lock, [&] { return head.get() != get_tail() ;});
+	return head_lock;
 }
 
 /*
  * Pop the head from queue and return popped head
  */
 template<typename T>
-std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::wait_pop_head()
+std::unique_ptr<typename threadsafe_queue<T>::node> threadsafe_queue<T>::wait_pop_head()
 {
 	/* Cond wait for queue to be non-empty and then get the lock of head node */
 	std::unique_lock<std::mutex> head_lock(wait_for_data());
@@ -116,7 +176,7 @@ std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::wait_pop_head()
  * Pop the head from queue and return popped head with value of popped head in parameter value
  */
 template<typename T>
-std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::wait_pop_head(T& value)
+std::unique_ptr<typename threadsafe_queue<T>::node> threadsafe_queue<T>::wait_pop_head(T& value)
 {
 	/* Cond wait for queue to be non-empty and then get the lock of head node */
 	std::unique_lock<std::mutex> head_lock(wait_for_data());
@@ -149,7 +209,7 @@ void threadsafe_queue<T>::wait_and_pop(T& value)
  * Non waiting pop head , return nullptr if queue is empty
  */
 template<typename T>
-std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::try_pop_head()
+std::unique_ptr<typename threadsafe_queue<T>::node> threadsafe_queue<T>::try_pop_head()
 {
 	std::lock_guard<std::mutex> head_lock(head_mutex);
 	if( head.get() == get_tail() )
@@ -165,7 +225,7 @@ std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::try_pop_head()
  * of popped
  */
 template<typename T>
-std::unique_ptr<threadsafe_queue::node> threadsafe_queue<T>::try_pop_head(T& value)
+std::unique_ptr<typename threadsafe_queue<T>::node> threadsafe_queue<T>::try_pop_head(T& value)
 {
 	std::lock_guard<std::mutex> head_lock(head_mutex);
 	if( head.get() == get_tail() )
@@ -195,7 +255,7 @@ template<typename T>
 bool threadsafe_queue<T>::try_pop(T& value)
 {
 	std::unique_ptr<threadsafe_queue::node> const old_head = try_pop_head(value);
-	return old_head;
+	return old_head != nullptr;
 }
 
 /*
@@ -205,6 +265,89 @@ template<typename T>
 bool threadsafe_queue<T>::empty()
 {
 	std::lock_guard<std::mutex> head_lock(head_mutex);
-	return ( head == get_tail());
+	return ( head.get() == get_tail());
+}
+
+/*
+ * Detach up to max nodes from the head under one head lock, returned as a chain ending in nullptr
+ */
+template<typename T>
+std::unique_ptr<typename threadsafe_queue<T>::node> threadsafe_queue<T>::try_pop_head_chain(std::size_t max)
+{
+	std::lock_guard<std::mutex> head_lock(head_mutex);
+	node* const current_tail = get_tail();
+	if( !max || head.get() == current_tail )
+	{
+		return std::unique_ptr<threadsafe_queue::node>();
+	}
+
+	node* last = head.get();
+	for( std::size_t count = 1 ; count < max && last->next.get() != current_tail ; count++ )
+	{
+		last = last->next.get();
+	}
+	std::unique_ptr<threadsafe_queue::node> chain = std::move(head);
+	head = std::move(last->next);
+	return chain;
+}
+
+/*
+ * Free a chain one node at a time, letting unique_ptr do it would recurse once per node
+ */
+template<typename T>
+void threadsafe_queue<T>::free_chain(std::unique_ptr<node> chain)
+{
+	while( chain )
+	{
+		chain = std::move(chain->next);
+	}
 }
 
+/*
+ * Non waiting pop of up to max values, written to out. Takes head_mutex once however many it pops and
+ * moves the values out after releasing it. Returns how many were popped
+ */
+template<typename T>
+template<typename OutputIterator>
+std::size_t threadsafe_queue<T>::try_pop_bulk(OutputIterator out, std::size_t max)
+{
+	std::unique_ptr<threadsafe_queue::node> chain = try_pop_head_chain(max);
+	std::size_t count = 0;
+	for( node* n = chain.get() ; n ; n = n->next.get(), count++ )
+	{
+		*out++ = std::move(*n->data);
+	}
+	free_chain(std::move(chain));
+	return count;
+}
+
+/*
+ * Non waiting pop of everything in the queue. The whole chain is swapped for a fresh dummy node under
+ * both locks without walking it, the values are moved out after releasing them
+ */
+template<typename T>
+std::vector<T> threadsafe_queue<T>::pop_all()
+{
+	std::unique_ptr<threadsafe_queue::node> fresh(new node);
+	std::unique_ptr<threadsafe_queue::node> chain;
+	{
+		std::lock_guard<std::mutex> head_lock(head_mutex);
+		std::lock_guard<std::mutex> tail_lock(tail_mutex);
+		if( head.get() == tail )
+		{
+			return std::vector<T>();
+		}
+		chain = std::move(head);
+		head = std::move(fresh);
+		tail = head.get();
+	}
+
+	/* The old dummy tail ends the chain and has no data */
+	std::vector<T> result;
+	for( node* n = chain.get() ; n->data ; n = n->next.get() )
+	{
+		result.push_back(std::move(*n->data));
+	}
+	free_chain(std::move(chain));
+	return result;
+}
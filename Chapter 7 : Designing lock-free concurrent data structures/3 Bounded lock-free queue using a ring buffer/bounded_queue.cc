@@ -0,0 +1,344 @@
+/*
+ * bounded_queue.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The threadsafe_queue in Chapter 6/6 allocates a node and a std::shared_ptr<T> for every push, and
+every producer serializes on tail_mutex and every consumer on head_mutex.
+
+bounded_queue has the same push() / try_pop() / wait_and_pop() / empty() surface, but it is a
+fixed array of slots and takes no lock :
+1. The capacity is fixed at construction (rounded up to a power of two). Nothing is allocated after
+   that, except by the std::shared_ptr<T> overloads of try_pop() and wait_and_pop().
+2. tail and head are plain counters of tickets handed out to producers and consumers. Ticket t
+   uses slot t % capacity, on lap t / capacity.
+3. Each slot has a sequence number saying whose turn it is. On lap n it is 2n while the slot
+   waits for a producer, and 2n + 1 once the value is in and it waits for a consumer. The consumer
+   sets it to 2(n + 1), for the producer of the next lap.
+   A producer never looks at head and a consumer never looks at tail, they only meet at a slot.
+4. push() and wait_and_pop() take a ticket with one fetch_add and then wait for their slot's turn :
+   a short spin, then std::atomic<>::wait() on the sequence number (a futex on Linux). push()
+   blocks while the queue is full, which is what makes it bounded.
+   try_push() and try_pop() take a ticket only if its slot is ready, with a compare-exchange,
+   so they never wait.
+5. head, tail and every slot sit on their own cache line. Without the padding a producer bumping
+   tail would evict the line that consumers are spinning on.
+6. A ticket, once taken, must end its turn or the slot is stuck for every later lap. So T must be
+   nothrow move constructible, which is all that happens while a ticket is held : try_push() of a
+   const& copies before it takes a ticket, and the pops move the value into a local T, end their
+   turn, and only then assign it or make_shared it. If that throws the value is lost, but the
+   queue carries on.
+A thread that has taken a ticket and is then descheduled holds up the thread that gets the next lap
+of that slot, so this is not lock-free in the strict sense. The other slots are not held up.
+ */
+#ifndef BOUNDED_QUEUE_CC
+#define BOUNDED_QUEUE_CC
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+template<typename T>
+class bounded_queue
+{
+	static_assert(std::is_nothrow_move_constructible<T>::value, "bounded_queue needs a nothrow move constructor");
+
+private:
+	static constexpr std::size_t cache_line_size = 64;
+
+	struct alignas(cache_line_size) slot
+	{
+		std::atomic<std::size_t> turn;
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		slot() : turn(0)
+		{}
+
+		T* value()
+		{
+			return std::launder(reinterpret_cast<T*>(storage));
+		}
+	};
+
+	std::size_t const mask;
+	unsigned const lap_shift;				// ticket >> lap_shift is the lap
+	std::unique_ptr<slot[]> slots;
+	alignas(cache_line_size) std::atomic<std::size_t> tail;		// next ticket for a producer
+	alignas(cache_line_size) std::atomic<std::size_t> head;		// next ticket for a consumer
+
+	static unsigned log2_ceil(std::size_t capacity);
+	static void wait_for_turn(slot& s, std::size_t turn);
+	static void end_turn(slot& s, std::size_t next_turn);
+	static T take(slot& s, std::size_t next_turn);
+
+	bool try_push_value(T&& new_value);
+	bool try_pop_ticket(std::size_t& ticket);
+
+public:
+	explicit bounded_queue(std::size_t capacity = 1024) :
+		mask((std::size_t(1) << log2_ceil(capacity)) - 1),
+		lap_shift(log2_ceil(capacity)),
+		slots(new slot[mask + 1]),
+		tail(0),
+		head(0)
+	{}
+
+	~bounded_queue();
+
+	bounded_queue(const bounded_queue& other) = delete;
+	bounded_queue& operator= (const bounded_queue& other) = delete;
+
+	std::shared_ptr<T> try_pop();
+	bool try_pop(T& value);
+	std::shared_ptr<T> wait_and_pop();
+	void wait_and_pop(T& value);
+	void push(T new_value);
+	bool try_push(T const& new_value);
+	bool try_push(T&& new_value);
+	bool empty() const;
+
+	std::size_t capacity() const
+	{
+		return mask + 1;
+	}
+};
+
+/*
+ * Number of bits needed for capacity slots, at least one slot
+ */
+template<typename T>
+unsigned bounded_queue<T>::log2_ceil(std::size_t capacity)
+{
+	unsigned bits = 0;
+	while( (std::size_t(1) << bits) < capacity )
+	{
+		bits++;
+	}
+	return bits;
+}
+
+/*
+ * Spin briefly, then sleep on the slot's sequence number until it reaches turn
+ */
+template<typename T>
+void bounded_queue<T>::wait_for_turn(slot& s, std::size_t turn)
+{
+	for( unsigned spins = 0 ; ; spins++ )
+	{
+		std::size_t const current = s.turn.load(std::memory_order_acquire);
+		if( current == turn )
+		{
+			return;
+		}
+		if( spins < 32 )
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			s.turn.wait(current, std::memory_order_acquire);
+		}
+	}
+}
+
+/*
+ * Hand the slot on. Both a producer and a consumer of different laps may be waiting on it
+ */
+template<typename T>
+void bounded_queue<T>::end_turn(slot& s, std::size_t next_turn)
+{
+	s.turn.store(next_turn, std::memory_order_release);
+	s.turn.notify_all();
+}
+
+/*
+ * With the slot's consumer turn held : move the value out, destroy it in the slot and hand the slot on.
+ * Nothing here can throw
+ */
+template<typename T>
+T bounded_queue<T>::take(slot& s, std::size_t next_turn)
+{
+	T* const data = s.value();
+	T result(std::move(*data));
+	data->~T();
+	end_turn(s, next_turn);
+	return result;
+}
+
+/*
+ * Destroy the values still in the queue. No other thread may be using it
+ */
+template<typename T>
+bounded_queue<T>::~bounded_queue()
+{
+	std::size_t const last = tail.load(std::memory_order_relaxed);
+	for( std::size_t ticket = head.load(std::memory_order_relaxed) ; ticket != last ; ticket++ )
+	{
+		slots[ticket & mask].value()->~T();
+	}
+}
+
+/*
+ * Push new_value of type T into the queue, waiting while the queue is full
+ */
+template<typename T>
+void bounded_queue<T>::push(T new_value)
+{
+	std::size_t const ticket = tail.fetch_add(1, std::memory_order_relaxed);
+	slot& s = slots[ticket & mask];
+	std::size_t const lap = ticket >> lap_shift;
+	wait_for_turn(s, 2 * lap);
+	new (s.storage) T(std::move(new_value));
+	end_turn(s, 2 * lap + 1);
+}
+
+/*
+ * Take the next producer ticket only if its slot is free on this lap. Returns false if the queue is full
+ */
+template<typename T>
+bool bounded_queue<T>::try_push_value(T&& new_value)
+{
+	std::size_t ticket = tail.load(std::memory_order_relaxed);
+	for( ;; )
+	{
+		slot& s = slots[ticket & mask];
+		std::size_t const lap = ticket >> lap_shift;
+		if( s.turn.load(std::memory_order_acquire) == 2 * lap )
+		{
+			if( tail.compare_exchange_weak(ticket, ticket + 1, std::memory_order_relaxed) )
+			{
+				new (s.storage) T(std::move(new_value));
+				end_turn(s, 2 * lap + 1);
+				return true;
+			}
+		}
+		else
+		{
+			/* The slot still holds last lap's value, unless another producer got this ticket meanwhile */
+			std::size_t const previous = ticket;
+			ticket = tail.load(std::memory_order_relaxed);
+			if( ticket == previous )
+			{
+				return false;
+			}
+		}
+	}
+}
+
+/*
+ * Non waiting push. new_value is left untouched if the queue is full. The copy is made before a ticket
+ * is taken, since it may throw
+ */
+template<typename T>
+bool bounded_queue<T>::try_push(T const& new_value)
+{
+	T copy(new_value);
+	return try_push_value(std::move(copy));
+}
+
+template<typename T>
+bool bounded_queue<T>::try_push(T&& new_value)
+{
+	return try_push_value(std::move(new_value));
+}
+
+/*
+ * Take the next consumer ticket only if its slot holds a value on this lap. Returns false if queue is empty
+ */
+template<typename T>
+bool bounded_queue<T>::try_pop_ticket(std::size_t& ticket)
+{
+	ticket = head.load(std::memory_order_relaxed);
+	for( ;; )
+	{
+		slot& s = slots[ticket & mask];
+		std::size_t const lap = ticket >> lap_shift;
+		if( s.turn.load(std::memory_order_acquire) == 2 * lap + 1 )
+		{
+			if( head.compare_exchange_weak(ticket, ticket + 1, std::memory_order_relaxed) )
+			{
+				return true;
+			}
+		}
+		else
+		{
+			std::size_t const previous = ticket;
+			ticket = head.load(std::memory_order_relaxed);
+			if( ticket == previous )
+			{
+				return false;
+			}
+		}
+	}
+}
+
+/*
+ * Non waiting pop. Return popped value in value parameter, true if popped and false if queue is empty
+ */
+template<typename T>
+bool bounded_queue<T>::try_pop(T& value)
+{
+	std::size_t ticket;
+	if( !try_pop_ticket(ticket) )
+	{
+		return false;
+	}
+	value = take(slots[ticket & mask], 2 * (ticket >> lap_shift) + 2);
+	return true;
+}
+
+/*
+ * Non waiting pop. Return pointer to popped data, nullptr if queue is empty
+ */
+template<typename T>
+std::shared_ptr<T> bounded_queue<T>::try_pop()
+{
+	std::size_t ticket;
+	if( !try_pop_ticket(ticket) )
+	{
+		return std::shared_ptr<T>();
+	}
+	return std::make_shared<T>(take(slots[ticket & mask], 2 * (ticket >> lap_shift) + 2));
+}
+
+/*
+ * Wait for a value and return it in value
+ */
+template<typename T>
+void bounded_queue<T>::wait_and_pop(T& value)
+{
+	std::size_t const ticket = head.fetch_add(1, std::memory_order_relaxed);
+	slot& s = slots[ticket & mask];
+	std::size_t const lap = ticket >> lap_shift;
+	wait_for_turn(s, 2 * lap + 1);
+	value = take(s, 2 * lap + 2);
+}
+
+/*
+ * Wait for a value and return pointer to it
+ */
+template<typename T>
+std::shared_ptr<T> bounded_queue<T>::wait_and_pop()
+{
+	std::size_t const ticket = head.fetch_add(1, std::memory_order_relaxed);
+	slot& s = slots[ticket & mask];
+	std::size_t const lap = ticket >> lap_shift;
+	wait_for_turn(s, 2 * lap + 1);
+	return std::make_shared<T>(take(s, 2 * lap + 2));
+}
+
+/*
+ * Check if queue is empty. Only a snapshot while other threads push and pop
+ */
+template<typename T>
+bool bounded_queue<T>::empty() const
+{
+	return head.load(std::memory_order_relaxed) >= tail.load(std::memory_order_relaxed);
+}
+
+#endif /* BOUNDED_QUEUE_CC */
@@ -0,0 +1,109 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * bounded_queue against the threadsafe_queue of Chapter 6/6, with 1 to 32 producer/consumer pairs.
+ * Producers push the time of the push, consumers pop with wait_and_pop() and record how long each
+ * value waited in the queue. The total number of values is the same for every row. It prints the
+ * throughput in millions of values per second and the 99th percentile of the time in the queue.
+ * The bounded_queue has 1024 slots, so producers block while it is full.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "bounded_queue.cc"
+#include "../../Chapter 6 : Designing lock based concurrent data structures/6 Thread safe queue with locking and waiting/demo.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+std::uint64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+struct result
+{
+	double values_per_us;
+	double p99_us;
+};
+
+template<typename Queue>
+result run(Queue& queue, unsigned pairs, unsigned long total)
+{
+	unsigned long const per_pair = total / pairs;
+	std::vector<std::vector<std::uint64_t>> latencies(pairs);
+	std::vector<std::thread> threads;
+
+	std::uint64_t const start = now_ns();
+	for( unsigned p = 0 ; p < pairs ; p++ )
+	{
+		threads.push_back(std::thread([&queue, per_pair]
+		{
+			for( unsigned long i = 0 ; i < per_pair ; i++ )
+			{
+				queue.push(now_ns());
+			}
+		}));
+		threads.push_back(std::thread([&queue, &latencies, per_pair, p]
+		{
+			/* One sample in 8 is plenty for a percentile and keeps the vector small */
+			latencies[p].reserve(per_pair / 8 + 1);
+			std::uint64_t pushed_at;
+			for( unsigned long i = 0 ; i < per_pair ; i++ )
+			{
+				queue.wait_and_pop(pushed_at);
+				if( (i & 7) == 0 )
+				{
+					latencies[p].push_back(now_ns() - pushed_at);
+				}
+			}
+		}));
+	}
+	for( unsigned long i = 0 ; i < threads.size() ; i++ )
+	{
+		threads[i].join();
+	}
+	std::uint64_t const stop = now_ns();
+
+	std::vector<std::uint64_t> all;
+	for( unsigned p = 0 ; p < pairs ; p++ )
+	{
+		all.insert(all.end(), latencies[p].begin(), latencies[p].end());
+	}
+	std::vector<std::uint64_t>::iterator const p99 = all.begin() + all.size() * 99 / 100;
+	std::nth_element(all.begin(), p99, all.end());
+
+	result r;
+	r.values_per_us = double(per_pair) * pairs * 1000 / (stop - start);
+	r.p99_us = *p99 / 1000.0;
+	return r;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const total = argc > 1 ? std::atol(argv[1]) : 1000000;
+	std::cout << "cores : " << std::thread::hardware_concurrency() << ", " << total << " values per row" << std::endl;
+	std::cout << "pairs   threadsafe_queue (M/s, p99 us)   bounded_queue (M/s, p99 us)" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for( unsigned pairs = 1 ; pairs <= 32 ; pairs *= 2 )
+	{
+		threadsafe_queue<std::uint64_t> locked;
+		bounded_queue<std::uint64_t> ring(1024);
+		result const a = run(locked, pairs, total);
+		result const b = run(ring, pairs, total);
+		std::cout << std::setw(5) << pairs
+				  << std::setw(14) << a.values_per_us << std::setw(12) << a.p99_us
+				  << std::setw(22) << b.values_per_us << std::setw(12) << b.p99_us << std::endl;
+	}
+	return 0;
+}
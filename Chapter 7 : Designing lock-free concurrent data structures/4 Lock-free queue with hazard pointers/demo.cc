@@ -0,0 +1,134 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Event fan-in : 1, 2, 4 and 8 producers push 4 million events into one queue and a single consumer
+ * drains it with try_pop(), through the threadsafe_queue of Chapter 6/6 (producers serialize on
+ * tail_mutex) and through lock_free_queue. It prints millions of events per second and checks that
+ * every event arrived in order. Each run is in its own process, and its peak resident memory is
+ * printed : popped nodes are freed as the run goes, so memory follows the backlog the consumer has
+ * not drained yet rather than the number of events pushed.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "lock_free_queue.cc"
+#include "../../Chapter 6 : Designing lock based concurrent data structures/6 Thread safe queue with locking and waiting/demo.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+struct event
+{
+	std::uint64_t sequence;
+	std::uint32_t source;
+	std::uint32_t kind;
+};
+
+/* Runs in the child. Returns false if an event was lost */
+template<typename Queue>
+bool run(unsigned producers, unsigned long total, double& events_per_us)
+{
+	unsigned long const per_producer = total / producers;
+	Queue queue;
+	std::vector<std::thread> threads;
+
+	clock_type::time_point const start = clock_type::now();
+	for( unsigned p = 0 ; p < producers ; p++ )
+	{
+		threads.push_back(std::thread([&queue, p, per_producer]
+		{
+			for( unsigned long i = 0 ; i < per_producer ; i++ )
+			{
+				queue.push(event{i, p, 1});
+			}
+		}));
+	}
+
+	std::vector<std::uint64_t> next(producers, 0);
+	bool in_order = true;
+	event e;
+	for( unsigned long received = 0 ; received < per_producer * producers ; )
+	{
+		if( !queue.try_pop(e) )
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		/* A single consumer sees each producer's events in the order they were pushed */
+		in_order = in_order && e.sequence == next[e.source];
+		next[e.source] = e.sequence + 1;
+		received++;
+	}
+	for( unsigned long i = 0 ; i < threads.size() ; i++ )
+	{
+		threads[i].join();
+	}
+	clock_type::time_point const stop = clock_type::now();
+
+	events_per_us = double(per_producer) * producers / std::chrono::duration<double, std::micro>(stop - start).count();
+	return in_order && queue.empty();
+}
+
+/* fork() so that each run's peak memory is its own */
+template<typename Queue>
+void measure(unsigned producers, unsigned long total)
+{
+	int fds[2];
+	if( pipe(fds) != 0 )
+	{
+		std::exit(1);
+	}
+	pid_t const child = fork();
+	if( child == 0 )
+	{
+		double result[2];
+		bool const ok = run<Queue>(producers, total, result[0]);
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		result[1] = ok ? usage.ru_maxrss / 1024.0 : -1;
+		ssize_t const written = write(fds[1], result, sizeof(result));
+		_exit(written == sizeof(result) ? 0 : 1);
+	}
+
+	double result[2] = { 0, -1 };
+	ssize_t const got = read(fds[0], result, sizeof(result));
+	waitpid(child, nullptr, 0);
+	close(fds[0]);
+	close(fds[1]);
+	if( got != sizeof(result) || result[1] < 0 )
+	{
+		std::cout << std::setw(16) << "LOST EVENTS";
+		return;
+	}
+	std::cout << std::setprecision(2) << std::setw(8) << result[0] << std::setprecision(0) << std::setw(8) << result[1];
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const total = argc > 1 ? std::atol(argv[1]) : 4000000;
+	std::cout << "cores : " << std::thread::hardware_concurrency() << ", " << total << " events" << std::endl;
+	std::cout << "producers   threadsafe_queue (M/s, MB)   lock_free_queue (M/s, MB)" << std::endl;
+	std::cout << std::fixed;
+	for( unsigned producers = 1 ; producers <= 8 ; producers *= 2 )
+	{
+		std::cout << std::setw(9) << producers << std::flush;
+		measure<threadsafe_queue<event>>(producers, total);
+		std::cout << "        " << std::flush;
+		measure<lock_free_queue<event>>(producers, total);
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,296 @@
+/*
+ * hazard_pointers.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+version2 of the lock-free stack in ../2 never deletes a popped node ("leak of old_head pointer"):
+another thread may have loaded the same head a moment earlier and be about to read its next. A node
+may only be freed once no thread can still be looking at it.
+
+Hazard pointers say who is looking :
+1. Each thread owns a record with two hazard pointers in a global table of max_threads records,
+   claimed on first use and given back when the thread exits.
+2. Before dereferencing a node it loaded from a shared atomic, a thread publishes the node's address
+   in one of its hazard pointers and then loads the atomic again. If it still holds the same node,
+   that node cannot have been unlinked and freed before the hazard pointer became visible, and nobody
+   will free it while the hazard pointer stays set (protect()).
+3. A node that has been unlinked is not deleted but retired onto a list of the retiring thread.
+   Once that list holds retire_threshold nodes, the thread collects every hazard pointer in the
+   table and deletes the retired nodes that none of them points to (scan()). retire_threshold is
+   four times the number of hazard pointers, so a scan frees at least three quarters of the list
+   and the cost per retired node is constant.
+4. Nodes still retired when a thread exits go onto a global list that the next scan of any thread
+   picks up. A thread that still uses hazard pointers after that, from a later thread_local or static
+   destructor, claims a record only while one of its hazard pointers is set, and each node it retires
+   is scanned at once and goes onto the global list if it is still protected.
+ */
+#ifndef HAZARD_POINTERS_CC
+#define HAZARD_POINTERS_CC
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class hazard_pointers
+{
+public:
+	static constexpr unsigned max_threads = 128;
+	static constexpr unsigned per_thread = 2;
+
+private:
+	static constexpr std::size_t retire_threshold = 4 * max_threads * per_thread;
+
+	struct alignas(64) hazard_record
+	{
+		std::atomic<std::thread::id> id;
+		std::atomic<void*> pointer[per_thread];
+	};
+
+	struct retired_node
+	{
+		void* p;
+		void (*deleter)(void*);
+	};
+
+	struct global_state
+	{
+		hazard_record records[max_threads];
+		std::mutex orphans_mutex;
+		std::vector<retired_node> orphans;
+		std::atomic<bool> has_orphans;
+
+		global_state() : has_orphans(false)
+		{}
+	};
+
+	/* Never destroyed : threads may exit, and retire nodes, during static destruction */
+	static global_state& global()
+	{
+		static global_state* const state = new global_state;
+		return *state;
+	}
+
+	static hazard_record* claim_record()
+	{
+		std::thread::id const none;
+		hazard_record* const records = global().records;
+		for( unsigned i = 0 ; i < max_threads ; i++ )
+		{
+			std::thread::id expected = none;
+			if( records[i].id.compare_exchange_strong(expected, std::this_thread::get_id()) )
+			{
+				return &records[i];
+			}
+		}
+		throw std::runtime_error("No hazard pointers available");
+	}
+
+	/* Hand nodes that are still protected to the next scan of any thread */
+	static void orphan(std::vector<retired_node>& retired)
+	{
+		if( !retired.empty() )
+		{
+			global_state& g = global();
+			std::lock_guard<std::mutex> lk(g.orphans_mutex);
+			g.orphans.insert(g.orphans.end(), retired.begin(), retired.end());
+			g.has_orphans.store(true, std::memory_order_release);
+		}
+	}
+
+	struct thread_state;
+
+	/* Trivially destructible, so it can still be read from later thread_local and static destructors */
+	struct state_pointer
+	{
+		thread_state* state;			// nullptr until first use, and again once torn down
+		hazard_record* late_record;		// after teardown, claimed only while one of its hazard pointers is set
+		bool torn_down;
+	};
+
+	static state_pointer& current()
+	{
+		static thread_local state_pointer pointer = { nullptr, nullptr, false };
+		return pointer;
+	}
+
+	/* The calling thread's record and retired list */
+	struct thread_state
+	{
+		hazard_record* record;
+		std::vector<retired_node> retired;
+
+		thread_state() : record(claim_record())
+		{
+			current().state = this;
+		}
+
+		~thread_state()
+		{
+			current().state = nullptr;
+			current().torn_down = true;
+			for( unsigned i = 0 ; i < per_thread ; i++ )
+			{
+				record->pointer[i].store(nullptr, std::memory_order_release);
+			}
+			scan(retired);
+			orphan(retired);
+			record->id.store(std::thread::id(), std::memory_order_release);
+		}
+	};
+
+	/* The calling thread's state, created on first use. nullptr once the thread has torn it down */
+	static thread_state* local()
+	{
+		state_pointer& pointer = current();
+		if( !pointer.state && !pointer.torn_down )
+		{
+			static thread_local thread_state state;
+		}
+		return pointer.state;
+	}
+
+	/* The record whose hazard pointers the calling thread publishes */
+	static hazard_record& record()
+	{
+		if( thread_state* const state = local() )
+		{
+			return *state->record;
+		}
+		state_pointer& pointer = current();
+		if( !pointer.late_record )
+		{
+			pointer.late_record = claim_record();
+		}
+		return *pointer.late_record;
+	}
+
+	/* Delete every node of retired that no hazard pointer points to, keep the others */
+	static void scan(std::vector<retired_node>& retired)
+	{
+		global_state& g = global();
+		if( g.has_orphans.load(std::memory_order_acquire) )
+		{
+			std::lock_guard<std::mutex> lk(g.orphans_mutex);
+			retired.insert(retired.end(), g.orphans.begin(), g.orphans.end());
+			g.orphans.clear();
+			g.has_orphans.store(false, std::memory_order_relaxed);
+		}
+
+		/* Pairs with the seq_cst store and reload in protect() */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::vector<void*> hazards;
+		hazards.reserve(max_threads * per_thread);
+		for( unsigned i = 0 ; i < max_threads ; i++ )
+		{
+			for( unsigned j = 0 ; j < per_thread ; j++ )
+			{
+				void* const p = g.records[i].pointer[j].load(std::memory_order_seq_cst);
+				if( p )
+				{
+					hazards.push_back(p);
+				}
+			}
+		}
+		std::sort(hazards.begin(), hazards.end());
+
+		std::size_t kept = 0;
+		for( std::size_t i = 0 ; i < retired.size() ; i++ )
+		{
+			if( std::binary_search(hazards.begin(), hazards.end(), retired[i].p) )
+			{
+				retired[kept++] = retired[i];
+			}
+			else
+			{
+				retired[i].deleter(retired[i].p);
+			}
+		}
+		retired.resize(kept);
+	}
+
+	template<typename Node>
+	static void delete_node(void* p)
+	{
+		delete static_cast<Node*>(p);
+	}
+
+public:
+	/* Load source and publish it in hazard pointer slot, until the two agree. Returns the protected node */
+	template<typename Node>
+	static Node* protect(std::atomic<Node*>& source, unsigned slot)
+	{
+		std::atomic<void*>& hazard = record().pointer[slot];
+		Node* p = source.load(std::memory_order_relaxed);
+		for( ;; )
+		{
+			hazard.store(p, std::memory_order_seq_cst);
+			Node* const again = source.load(std::memory_order_seq_cst);
+			if( again == p )
+			{
+				return p;
+			}
+			p = again;
+		}
+	}
+
+	/* Publish p without validating it, for a caller that validates it itself */
+	static void set(unsigned slot, void* p)
+	{
+		record().pointer[slot].store(p, std::memory_order_seq_cst);
+	}
+
+	static void clear(unsigned slot)
+	{
+		if( thread_state* const state = local() )
+		{
+			state->record->pointer[slot].store(nullptr, std::memory_order_release);
+			return;
+		}
+
+		/* After teardown, give the record back as soon as none of its hazard pointers is set */
+		state_pointer& pointer = current();
+		hazard_record* const late = pointer.late_record;
+		if( !late )
+		{
+			return;
+		}
+		late->pointer[slot].store(nullptr, std::memory_order_release);
+		for( unsigned i = 0 ; i < per_thread ; i++ )
+		{
+			if( late->pointer[i].load(std::memory_order_relaxed) )
+			{
+				return;
+			}
+		}
+		pointer.late_record = nullptr;
+		late->id.store(std::thread::id(), std::memory_order_release);
+	}
+
+	/* node has been unlinked : delete it once no hazard pointer points to it */
+	template<typename Node>
+	static void retire(Node* node)
+	{
+		thread_state* const state = local();
+		if( !state )
+		{
+			std::vector<retired_node> late(1, retired_node{node, &delete_node<Node>});
+			scan(late);
+			orphan(late);
+			return;
+		}
+		std::vector<retired_node>& retired = state->retired;
+		retired.push_back(retired_node{node, &delete_node<Node>});
+		if( retired.size() >= retire_threshold )
+		{
+			scan(retired);
+		}
+	}
+};
+
+#endif /* HAZARD_POINTERS_CC */
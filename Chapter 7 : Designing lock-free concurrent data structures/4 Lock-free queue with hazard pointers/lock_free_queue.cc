@@ -0,0 +1,226 @@
+/*
+ * lock_free_queue.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+An unbounded multi-producer multi-consumer queue without locks (Michael and Scott), with the
+push() / try_pop() / empty() surface of the threadsafe_queue in Chapter 6/6. In that queue every
+producer takes tail_mutex, so fan-in from many producers serializes on one lock.
+
+1. Like Chapter 6/6 the queue is a singly linked list that starts with a dummy node. head points to
+   the dummy, and the first value is in head->next.
+2. push() links a new node after the last one with a compare-exchange on last->next (null to new
+   node), then swings tail to it. tail may lag one node behind : any thread that finds
+   tail->next set first helps by moving tail forward, so no thread waits for a producer that
+   stalls between the two steps.
+3. try_pop() moves head from the dummy to the first node with a compare-exchange. The winner moves
+   the value out of that node, which becomes the new dummy, and retires the old dummy. A guard
+   destroys the value left in the node, clears the hazard pointers and retires the old dummy before
+   the value is assigned or copied into a shared_ptr. A throwing move or make_shared() then loses
+   only that value, and the node is still freed.
+4. Nodes are freed through hazard pointers (hazard_pointers.cc) : a thread protects the node it is
+   about to dereference (tail in push(), head and head->next in try_pop()), and a retired node is
+   deleted only once no hazard pointer points to it. Nothing leaks and nothing is freed under a reader.
+Every push() allocates one node. Values are moved in and out, and no lock is taken.
+ */
+#ifndef LOCK_FREE_QUEUE_CC
+#define LOCK_FREE_QUEUE_CC
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+#include "hazard_pointers.cc"
+
+template<typename T>
+class lock_free_queue
+{
+private:
+	struct node
+	{
+		std::atomic<node*> next;
+		alignas(T) unsigned char storage[sizeof(T)];		// empty in the dummy
+
+		node() : next(nullptr)
+		{}
+
+		T* value()
+		{
+			return std::launder(reinterpret_cast<T*>(storage));
+		}
+	};
+
+	alignas(64) std::atomic<node*> head;
+	alignas(64) std::atomic<node*> tail;
+
+	/* Cleanup of the thread that won head, however it leaves pop_head() */
+	struct popped_guard
+	{
+		node* first;		// the old dummy
+		T* data;			// value in the new dummy
+
+		~popped_guard()
+		{
+			data->~T();
+			hazard_pointers::clear(1);
+			hazard_pointers::clear(0);
+			hazard_pointers::retire(first);
+		}
+	};
+
+	static T take(node* first, node* next);
+
+	template<typename Receive>
+	bool pop_head(Receive receive);
+
+public:
+	lock_free_queue() : head(new node)
+	{
+		tail.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	~lock_free_queue();
+
+	lock_free_queue(const lock_free_queue& other) = delete;
+	lock_free_queue& operator= (const lock_free_queue& other) = delete;
+
+	std::shared_ptr<T> try_pop();
+	bool try_pop(T& value);
+	void push(T new_value);
+	bool empty();
+};
+
+/*
+ * No other thread may be using the queue. The first node is the dummy and holds no value
+ */
+template<typename T>
+lock_free_queue<T>::~lock_free_queue()
+{
+	node* n = head.load(std::memory_order_relaxed);
+	node* next = n->next.load(std::memory_order_relaxed);
+	delete n;
+	for( n = next ; n ; n = next )
+	{
+		next = n->next.load(std::memory_order_relaxed);
+		n->value()->~T();
+		delete n;
+	}
+}
+
+/*
+ * Push new_value of type T into the queue
+ */
+template<typename T>
+void lock_free_queue<T>::push(T new_value)
+{
+	std::unique_ptr<node> fresh(new node);
+	new (fresh->storage) T(std::move(new_value));
+	node* const p = fresh.release();
+
+	for( ;; )
+	{
+		node* last = hazard_pointers::protect(tail, 0);
+		node* next = last->next.load(std::memory_order_acquire);
+		if( next )
+		{
+			/* A producer linked a node but has not moved tail yet, do it for it */
+			tail.compare_exchange_weak(last, next, std::memory_order_release, std::memory_order_relaxed);
+			continue;
+		}
+		if( last->next.compare_exchange_weak(next, p, std::memory_order_release, std::memory_order_relaxed) )
+		{
+			/* If this fails someone has already helped */
+			tail.compare_exchange_strong(last, p, std::memory_order_release, std::memory_order_relaxed);
+			break;
+		}
+	}
+	hazard_pointers::clear(0);
+}
+
+/*
+ * Move the value out of next, then clean up after the pop even if the move throws
+ */
+template<typename T>
+T lock_free_queue<T>::take(node* first, node* next)
+{
+	popped_guard guard{first, next->value()};
+	return std::move(*guard.data);
+}
+
+/*
+ * Move head onto the first value's node and hand the value to receive. false if the queue is empty
+ */
+template<typename T>
+template<typename Receive>
+bool lock_free_queue<T>::pop_head(Receive receive)
+{
+	for( ;; )
+	{
+		node* const first = hazard_pointers::protect(head, 0);
+		node* const next = first->next.load(std::memory_order_acquire);
+		if( !next )
+		{
+			hazard_pointers::clear(0);
+			return false;
+		}
+
+		/* next cannot be retired before first is, and first is still head, so protecting it is enough */
+		hazard_pointers::set(1, next);
+		if( head.load(std::memory_order_seq_cst) != first )
+		{
+			continue;
+		}
+
+		/* Do not let head pass tail : move a lagging tail on first */
+		node* const last = tail.load(std::memory_order_acquire);
+		if( first == last )
+		{
+			node* expected = last;
+			tail.compare_exchange_strong(expected, next, std::memory_order_release, std::memory_order_relaxed);
+			continue;
+		}
+
+		node* expected = first;
+		if( head.compare_exchange_strong(expected, next, std::memory_order_acq_rel, std::memory_order_relaxed) )
+		{
+			/* Only the winner touches the value in next, which is now the dummy. receive runs after the cleanup */
+			receive(take(first, next));
+			return true;
+		}
+	}
+}
+
+/*
+ * Non waiting pop. Return popped value in value parameter, true if popped and false if queue is empty
+ */
+template<typename T>
+bool lock_free_queue<T>::try_pop(T& value)
+{
+	return pop_head([&value](T&& data) { value = std::move(data); });
+}
+
+/*
+ * Non waiting pop. Return pointer to popped data, nullptr if queue is empty
+ */
+template<typename T>
+std::shared_ptr<T> lock_free_queue<T>::try_pop()
+{
+	std::shared_ptr<T> result;
+	pop_head([&result](T&& data) { result = std::make_shared<T>(std::move(data)); });
+	return result;
+}
+
+/*
+ * Check if queue is empty. Only a snapshot while other threads push and pop
+ */
+template<typename T>
+bool lock_free_queue<T>::empty()
+{
+	node* const first = hazard_pointers::protect(head, 0);
+	bool const result = first->next.load(std::memory_order_acquire) == nullptr;
+	hazard_pointers::clear(0);
+	return result;
+}
+
+#endif /* LOCK_FREE_QUEUE_CC */
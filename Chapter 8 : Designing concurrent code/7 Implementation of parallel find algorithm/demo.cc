@@ -31,10 +31,16 @@ in a block 1), so all threads are joined when you check the flag to see whether
 match was found 1#. If a match was found, you can get the result or throw the
 stored exception by calling get() on the std::future<Iterator> you can get from
 the promise 1$.
+
+NOTE : The done_flag is now a C++20 std::stop_source. The threads get a std::stop_token from it and
+request_stop() plays the part of done_flag->store(true). The token is read once every poll_interval
+elements instead of on every element, so the inner loop has no atomic load in it.
  */
 
-#include <atomic>
+#include <algorithm>
 #include <future>
+#include <iterator>
+#include <stop_token>
 #include <thread>
 #include <vector>
 
@@ -67,34 +73,45 @@ Iterator parallel_find(Iterator first, Iterator last, MatchType match)
 						Iterator end,
 						MatchType match,
 						std::promise<Iterator> *result,
-						std::atomic<bool> *done_flag)
+						std::stop_source *stop)
 		{
+			unsigned long const poll_interval = 1024;
 			try
 			{
-				// Loops through the elements in the block its been given, checking the flag at each
-				// step
-				for( ; (begin != end) && !done_flag->load() ; begin++ )
+				// Loops through the elements in the block its been given, checking the token every
+				// poll_interval elements
+				// The block is measured once : std::distance walks every node of a list
+				std::stop_token const token = stop->get_token();
+				unsigned long remaining = std::distance(begin, end);
+				while( (remaining > 0) && !token.stop_requested() )
 				{
-					if( *begin == match )
+					unsigned long const chunk_length = std::min(poll_interval, remaining);
+					Iterator chunk_end = begin;
+					std::advance(chunk_end, chunk_length);
+					remaining -= chunk_length;
+					for( ; begin != chunk_end ; begin++ )
 					{
-						// If a match is found, it sets the final result value in the promise and then
-						// sets the done_flag before returning
-						result->set_value(begin);
-						done_flag->store(true);
-						return;
+						if( *begin == match )
+						{
+							// If a match is found, it sets the final result value in the promise and then
+							// requests stop before returning
+							result->set_value(begin);
+							stop->request_stop();
+							return;
+						}
 					}
 				}
 			}
 			//If an exception is thrown, this is caught by catchall handler
 			catch(...)
 			{
-				// Try to store exception in a promise, before setting done_flag
+				// Try to store exception in a promise, before requesting stop
 				// Setting the value on the promise might throw an exception if promise is already set, so
 				// you catch and discard any exceptions that happen here
 				try
 				{
 					result->set_exception(std::current_exception());
-					done_flag->store(true);
+					stop->request_stop();
 				}
 				catch(...)
 				{}
@@ -119,10 +136,10 @@ Iterator parallel_find(Iterator first, Iterator last, MatchType match)
 
 	unsigned long const block_size = length / num_threads;
 
-	// promise and flag used to stop the search , both of which are passed in to the new threads
+	// promise and stop_source used to stop the search , both of which are passed in to the new threads
 	// along with range of search
 	std::promise<Iterator> result;
-	std::atomic<bool> done_flag(false);
+	std::stop_source stop;
 	std::vector<std::thread> threads(num_threads-1);
 	{
 		// thread joiner at end of {} scope
@@ -135,17 +152,17 @@ Iterator parallel_find(Iterator first, Iterator last, MatchType match)
 			std::advance(block_end, block_size);
 
 			// launch thread
-			threads[i] = std::thread(find_element(), block_start, block_end, match, &result, &done_flag);
+			threads[i] = std::thread(find_element(), block_start, block_end, match, &result, &stop);
 
 			block_start = block_end;
 		}
 
 		// call find_element on main thread
-		find_element()(block_start, last, match, &result, &done_flag);
+		find_element()(block_start, last, match, &result, &stop);
 	}// At this point all THREADS WILL BE JOINED
 
 	// Check if a match is found or not
-	if( !done_flag.load() )
+	if( !stop.stop_requested() )
 	{
 		return last;	// not found
 	}
@@ -42,12 +42,16 @@ through the get() call 1) . The use of a try/catch block around the whole thing
 there to set the done flag on an exception and ensure that all threads terminate quickly
 if an exception is thrown 1!. The implementation would still be correct without it but
 would keep checking elements until every thread was finished.
+
+NOTE : The done flag is now a C++20 std::stop_source, request_stop() sets it. A leaf range is at most
+2*min_per_thread elements, so it is checked once per leaf rather than once per element.
  */
-#include <atomic>
+#include <functional>
 #include <future>
+#include <stop_token>
 
 template<typename Iterator, typename MatchType>
-Iterator parallel_find_impl(Iterator first, Iterator last, MatchType match, std::atomic<bool>& done)
+Iterator parallel_find_impl(Iterator first, Iterator last, MatchType match, std::stop_source& stop)
 {
 	try
 	{
@@ -58,32 +62,36 @@ Iterator parallel_find_impl(Iterator first, Iterator last, MatchType match, std:
 		unsigned long const min_per_thread = 25;
 		if( length < (2*min_per_thread) )
 		{
-			/* Loop until you reach the end of the range or the done flag is set */
-			for( ; (first != last) && !done.load() ; first++ )
+			/* Loop until you reach the end of the range, unless another thread has already found it */
+			if( stop.stop_requested() )
+			{
+				return last;
+			}
+			for( ; first != last ; first++ )
 			{
 				if( *first == match )
 				{
-					// If you find a match, done flag is set before returning
-					done = true;
+					// If you find a match, stop is requested before returning
+					stop.request_stop();
 					return first;
 				}
-				return last;
 			}
+			return last;
 		}
 		else
 		{
 			Iterator const mid_point = first + (length/2);
 
 			// std::async searches in the second half
-			// NOTE : Careful to use std::ref to pass reference to the done flag
+			// NOTE : Careful to use std::ref to pass reference to the stop_source
 			// 1. If direct recursion throws an exception, the future's destructor will ensure
 			// that the thread running async call has terminated before function returns.
 			// 2. If async call throws, the exception is propagated through the get() call
 			std::future<Iterator> async_result = std::async(&parallel_find_impl<Iterator,MatchType>,
-															mid_point, last, match, std::ref(done));
+															mid_point, last, match, std::ref(stop));
 
 			// Search first half by doing a direct recursive call
-			Iterator const direct_result = parallel_find_impl(first, last, match, done);
+			Iterator const direct_result = parallel_find_impl(first, mid_point, match, stop);
 
 			/* If direct serach returned mid_point, then it failed to find a match, so you need to get
 			 * the result of async search. If no result will be find in that half, the result will be last
@@ -100,7 +108,7 @@ Iterator parallel_find_impl(Iterator first, Iterator last, MatchType match, std:
 		 * The impl would still be correct without it but would keep checking elements until every
 		 * thread was finished.
 		 */
-		done = true;
+		stop.request_stop();
 		throw;
 	}
 }
@@ -108,8 +116,8 @@ Iterator parallel_find_impl(Iterator first, Iterator last, MatchType match, std:
 template<typename Iterator, typename MatchType>
 Iterator parallel_find(Iterator first, Iterator last, MatchType match)
 {
-	std::atomic<bool> done(false);
-	return parallel_find_impl(first, last, match , done);
+	std::stop_source stop;
+	return parallel_find_impl(first, last, match , stop);
 }
 
 
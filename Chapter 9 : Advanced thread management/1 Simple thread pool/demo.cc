@@ -16,6 +16,8 @@ nization yourself.
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <functional>
+#include "../7 Parking idle workers with an eventcount/eventcount.cc"
 
 /* Implementation in other chapter */
 struct join_threads
@@ -35,12 +37,16 @@ class thread_pool
 	 *	  until all the threads have stopped.
 	 */
 	std::atomic_bool done;
+	idle_options const idle;
+	eventcount work_available;
 	thread_safe_queue<std::function<void()>> work_queue;
 	std::vector<std::thread> threads;
 	join_threads joiner;
 
 	void worker_thread()
 	{
+		idle_backoff backoff(idle);
+
 		/* Sit in loop waiting until the done flag is set */
 		while( !done )
 		{
@@ -51,10 +57,16 @@ class thread_pool
 			{
 				// execute task
 				task();
+				backoff.reset();
 			}
-			else
+			else if( !backoff.backoff() )
 			{
-				std::this_thread::yield();
+				/*
+				 * Spun and yielded for a while without finding work : park until submit() or the destructor
+				 * signals, instead of burning the core with yield() (see ../7)
+				 */
+				work_available.wait([this] { return done || !work_queue.empty(); });
+				backoff.reset();
 			}
 		}
 	}
@@ -62,7 +74,7 @@ class thread_pool
 
 public:
 	/* Constructor */
-	thread_pool() : done(false), joiner(threads)
+	explicit thread_pool(idle_options idle_ = idle_options()) : done(false), idle(idle_), joiner(threads)
 	{
 		// Get hardware concurrency count
 		unsigned const thread_count = std::thread::hardware_concurrency();
@@ -83,6 +95,7 @@ public:
 			 * block that sets the done flag when an exception is thrown.
 			 */
 			done = true;
+			work_available.notify_all();
 			throw;
 		}
 	}
@@ -91,6 +104,7 @@ public:
 	~thread_pool()
 	{
 		done = true;
+		work_available.notify_all();
 	}
 
 	/* Submit a task to work queue */
@@ -98,6 +112,9 @@ public:
 	void submit(FunctionType f)
 	{
 		work_queue.push(std::function<void()>(f));
+
+		/* Wake a parked worker, only costs a fence and a load when none are parked */
+		work_available.notify_one();
 	}
 
 };
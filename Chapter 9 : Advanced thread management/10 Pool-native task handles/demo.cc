@@ -0,0 +1,130 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Per-task overhead of the ../6 pool with 25 element blocks, as in ../3 :
+ * 1. std::packaged_task<> + std::future<>, as the earlier pools do it (queued with post()).
+ * 2. submit() returning a task_handle<> from the slab allocator.
+ * Global operator new is counted to show where the allocations went.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+static std::atomic<unsigned long> allocation_count(0);
+
+/*
+ * Replacing the global operator new and delete with malloc and free is intentional : it is what counts
+ * the allocations. Where GCC inlines cpu_topology's vector destructors it sees free() release memory
+ * from operator new and warns.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if( void* p = std::malloc(size ? size : 1) )
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+#pragma GCC diagnostic pop
+
+typedef std::chrono::steady_clock clock_type;
+
+struct accumulate_block
+{
+	long const* first;
+	long const* last;
+	long operator()() const
+	{
+		return std::accumulate(first, last, 0l);
+	}
+};
+
+/* The packaged_task lives inside the queued lambda, so the queue entry itself needs no extra allocation */
+long with_packaged_task(thread_pool& pool, std::vector<long> const& data, unsigned long block_size)
+{
+	std::vector<std::future<long>> results;
+	for( unsigned long i = 0 ; i < data.size() ; i += block_size )
+	{
+		std::packaged_task<long()> task(accumulate_block{&data[i], &data[0] + std::min(i + block_size, data.size())});
+		results.push_back(task.get_future());
+		pool.post([task = std::move(task)]() mutable { task(); });
+	}
+
+	long sum = 0;
+	for( unsigned long i = 0 ; i < results.size() ; i++ )
+	{
+		sum += results[i].get();
+	}
+	return sum;
+}
+
+long with_task_handle(thread_pool& pool, std::vector<long> const& data, unsigned long block_size)
+{
+	std::vector<task_handle<long>> results;
+	for( unsigned long i = 0 ; i < data.size() ; i += block_size )
+	{
+		results.push_back(pool.submit(accumulate_block{&data[i], &data[0] + std::min(i + block_size, data.size())}));
+	}
+
+	long sum = 0;
+	for( unsigned long i = 0 ; i < results.size() ; i++ )
+	{
+		sum += results[i].get();
+	}
+	return sum;
+}
+
+template<typename Function>
+void measure(char const* name, Function f, std::vector<long> const& data, unsigned long block_size, long expected)
+{
+	thread_pool pool;
+	f(pool, data, block_size);		// warm up : slabs and queues reach their steady-state size
+
+	unsigned long const tasks = (data.size() + block_size - 1) / block_size;
+	unsigned long const allocations_before = allocation_count.load();
+	clock_type::time_point const start = clock_type::now();
+	long const result = f(pool, data, block_size);
+	clock_type::time_point const stop = clock_type::now();
+
+	std::cout << name << " : " << std::chrono::duration<double, std::nano>(stop - start).count() / tasks
+			  << " ns/task, " << double(allocation_count.load() - allocations_before) / tasks
+			  << " allocations/task" << (result == expected ? "" : " WRONG RESULT") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const length = argc > 1 ? std::atol(argv[1]) : 2500000;
+	unsigned long const block_size = 25;
+
+	std::vector<long> data(length);
+	std::iota(data.begin(), data.end(), 0);
+	long const expected = std::accumulate(data.begin(), data.end(), 0l);
+
+	measure("std::packaged_task + std::future", with_packaged_task, data, block_size, expected);
+	measure("submit() + task_handle          ", with_task_handle, data, block_size, expected);
+	return 0;
+}
@@ -0,0 +1,263 @@
+/*
+ * slab_allocator.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+A tiny per-thread allocator for the small fixed-size objects a thread pool churns through (task
+shared states, deque nodes).
+
+1. Every thread has one slab per size class (64, 128, 256, 512 bytes). A slab carves blocks out of
+   chunks of 64 blocks and keeps freed blocks on a free list, so in steady state nothing reaches
+   malloc.
+2. Each block starts with a small header pointing to the slab it came from. A task's state is
+   usually allocated by the submitting thread and freed by whichever thread drops the last
+   reference, so a block can be freed by a thread that does not own the slab.
+3. The owner frees onto its plain local free list. Any other thread pushes the block onto the
+   slab's remote_free list with a compare_exchange. When the local list runs dry, the owner takes
+   the whole remote list with one exchange(). Remote pushes never pop, so there is no ABA problem.
+4. When a thread exits, its slabs go onto a global orphan list and the next new thread adopts them.
+   Memory is therefore bounded by the peak number of live blocks, not by the number of threads
+   ever created. A thread that allocates or frees after that, from a later thread_local or static
+   destructor, no longer owns any slab : it frees through the remote list and allocates with
+   ::operator new.
+5. Bigger requests fall back to ::operator new, with the same header so deallocate() can tell.
+ */
+#ifndef SLAB_ALLOCATOR_CC
+#define SLAB_ALLOCATOR_CC
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+class slab_allocator
+{
+	/* Header in front of every block, 16 bytes so the payload stays max_align_t aligned */
+	struct alignas(16) block_header
+	{
+		slab_allocator* owner;		// nullptr : block came from ::operator new
+	};
+
+	/* Free blocks reuse their own memory as the list link */
+	struct free_block
+	{
+		free_block* next;
+	};
+
+	static std::size_t const blocks_per_chunk = 64;
+
+	std::size_t const block_size;		// header included
+	unsigned const size_class;
+	free_block* local_free;				// owner only
+	std::atomic<free_block*> remote_free;
+	std::vector<std::unique_ptr<unsigned char[]>> chunks;
+
+	void grow()
+	{
+		unsigned char* const chunk = new unsigned char[block_size * blocks_per_chunk];
+		chunks.emplace_back(chunk);
+		for( std::size_t i = 0 ; i < blocks_per_chunk ; i++ )
+		{
+			free_block* const b = reinterpret_cast<free_block*>(chunk + i * block_size);
+			b->next = local_free;
+			local_free = b;
+		}
+	}
+
+	void* allocate_block()
+	{
+		if( !local_free )
+		{
+			local_free = remote_free.exchange(nullptr, std::memory_order_acquire);
+		}
+		if( !local_free )
+		{
+			grow();
+		}
+
+		free_block* const b = local_free;
+		local_free = b->next;
+
+		block_header* const header = ::new (static_cast<void*>(b)) block_header;
+		header->owner = this;
+		return header + 1;
+	}
+
+	void free_block_from_any_thread(block_header* header, bool owner_thread)
+	{
+		free_block* const b = reinterpret_cast<free_block*>(header);
+		if( owner_thread )
+		{
+			b->next = local_free;
+			local_free = b;
+			return;
+		}
+
+		b->next = remote_free.load(std::memory_order_relaxed);
+		while( !remote_free.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed) );
+	}
+
+	/* Slabs of the calling thread, one per size class */
+	static unsigned const size_classes = 4;
+
+	struct orphan_list
+	{
+		std::mutex mut;
+		std::vector<slab_allocator*> slabs[size_classes];
+	};
+
+	/* Never destroyed : blocks may be freed during static destruction */
+	static orphan_list& orphans()
+	{
+		static orphan_list* const list = new orphan_list;
+		return *list;
+	}
+
+	struct thread_cache;
+
+	/* Trivially destructible, so it can still be read from later thread_local and static destructors */
+	struct cache_pointer
+	{
+		thread_cache* cache;		// nullptr until first use, and again once torn down
+		bool torn_down;
+	};
+
+	static cache_pointer& current()
+	{
+		static thread_local cache_pointer pointer = { nullptr, false };
+		return pointer;
+	}
+
+	struct thread_cache
+	{
+		slab_allocator* slabs[size_classes];
+
+		thread_cache()
+		{
+			orphan_list& list = orphans();
+			std::lock_guard<std::mutex> lk(list.mut);
+			for( unsigned i = 0 ; i < size_classes ; i++ )
+			{
+				if( !list.slabs[i].empty() )
+				{
+					slabs[i] = list.slabs[i].back();
+					list.slabs[i].pop_back();
+				}
+				else
+				{
+					slabs[i] = new slab_allocator(std::size_t(64) << i, i);
+				}
+			}
+			current().cache = this;
+		}
+
+		/* Another thread may adopt the slabs as soon as they are on the orphan list, let go of them first */
+		~thread_cache()
+		{
+			current().cache = nullptr;
+			current().torn_down = true;
+			orphan_list& list = orphans();
+			std::lock_guard<std::mutex> lk(list.mut);
+			for( unsigned i = 0 ; i < size_classes ; i++ )
+			{
+				list.slabs[i].push_back(slabs[i]);
+			}
+		}
+	};
+
+	/* The calling thread's slabs, created on first use. nullptr once the thread has torn them down */
+	static thread_cache* local_cache()
+	{
+		cache_pointer& pointer = current();
+		if( !pointer.cache && !pointer.torn_down )
+		{
+			static thread_local thread_cache cache;
+		}
+		return pointer.cache;
+	}
+
+	slab_allocator(std::size_t block_size_, unsigned size_class_) : block_size(block_size_), size_class(size_class_),
+																	 local_free(nullptr), remote_free(nullptr)
+	{}
+
+public:
+	slab_allocator(const slab_allocator&) = delete;
+	slab_allocator& operator = (const slab_allocator&) = delete;
+
+	/* Allocate size bytes, aligned for any type up to 16 bytes alignment */
+	static void* allocate(std::size_t size)
+	{
+		std::size_t const needed = size + sizeof(block_header);
+		if( thread_cache* const cache = local_cache() )
+		{
+			for( unsigned i = 0 ; i < size_classes ; i++ )
+			{
+				if( needed <= (std::size_t(64) << i) )
+				{
+					return cache->slabs[i]->allocate_block();
+				}
+			}
+		}
+
+		block_header* const header = ::new (::operator new(needed)) block_header;
+		header->owner = nullptr;
+		return header + 1;
+	}
+
+	/* Free memory from allocate(), from any thread */
+	static void deallocate(void* p)
+	{
+		block_header* const header = static_cast<block_header*>(p) - 1;
+		slab_allocator* const owner = header->owner;
+		if( !owner )
+		{
+			::operator delete(header);
+			return;
+		}
+		/* Freeing needs no cache of our own : a thread without one cannot own the slab */
+		thread_cache* const cache = current().cache;
+		owner->free_block_from_any_thread(header, cache && cache->slabs[owner->size_class] == owner);
+	}
+};
+
+template<typename T, typename... Args>
+T* slab_new(Args&&... args)
+{
+	static_assert(alignof(T) <= 16, "slab_allocator only guarantees 16 byte alignment");
+	void* const memory = slab_allocator::allocate(sizeof(T));
+	try
+	{
+		return ::new (memory) T(std::forward<Args>(args)...);
+	}
+	catch(...)
+	{
+		slab_allocator::deallocate(memory);
+		throw;
+	}
+}
+
+template<typename T>
+void slab_delete(T* p)
+{
+	if( p )
+	{
+		p->~T();
+		slab_allocator::deallocate(p);
+	}
+}
+
+/* Deleter for std::unique_ptr<T, slab_deleter> */
+struct slab_deleter
+{
+	template<typename T>
+	void operator()(T* p) const
+	{
+		slab_delete(p);
+	}
+};
+
+#endif /* SLAB_ALLOCATOR_CC */
@@ -0,0 +1,552 @@
+/*
+ * task_handle.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+submit() in the earlier pools wraps every task in a std::packaged_task<> and hands back a
+std::future<>. That costs a heap allocation for the shared state, another one for the task inside
+it, and libstdc++ waits on a mutex and a condition variable.
+
+task_handle<T> is a future made for the pool :
+1. The shared state (task_state<T>) comes from the calling thread's slab_allocator, so in steady
+   state it costs no malloc.
+2. Completion is a single atomic status word. A waiter flips pending -> pending_with_waiters and
+   sleeps on it with std::atomic<>::wait (a futex). The finishing task only calls notify_all()
+   when it sees that flag, so nobody waiting costs nothing.
+3. Two references to the state, one held by the handle and one by the queued task. Whichever
+   drops its reference last frees the state.
+4. get()/wait() on a pool thread runs other pending tasks while the result is not ready, like
+   the run_pending_task() loop in ../4, so a worker waiting on a sub-task never sits idle.
+5. If the queued task is destroyed without running (pool shut down), the handle gets a
+   std::future_error(broken_promise), just like a std::packaged_task<>.
+6. then(f) consumes the handle and returns a handle to f's result. Once the task is done, f is
+   queued on the same pool and gets the finished handle, so nobody blocks waiting in between
+   (see ../14 for when_all() and when_any()).
+ */
+#ifndef TASK_HANDLE_CC
+#define TASK_HANDLE_CC
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "slab_allocator.cc"
+#include "../7 Parking idle workers with an eventcount/eventcount.cc"
+
+class scheduled_continuation;
+
+/* What a task_handle needs from its pool to help out while waiting */
+class pending_task_runner
+{
+public:
+	/* Run one pending task if there is one, false if there was nothing to run */
+	virtual bool run_pending_task() = 0;
+
+	/* True if the calling thread is one of this pool's workers */
+	virtual bool is_pool_thread() const = 0;
+
+	/*
+	 * Queue a continuation whose task has just finished. A pool that does not override this runs it
+	 * straight away on the thread that finished the task.
+	 */
+	virtual void schedule(scheduled_continuation* c);
+
+protected:
+	~pending_task_runner() {}
+};
+
+/* Attached to a task_state, fired exactly once by whichever thread makes the state ready */
+class continuation_base
+{
+public:
+	virtual void fire() = 0;
+
+protected:
+	~continuation_base() {}
+};
+
+/*
+ * A continuation that runs user code, so fire() hands it to its pool instead of running it on the
+ * thread that finished the task. Exactly one of run() and abandon() is called, and it frees the object.
+ */
+class scheduled_continuation : public continuation_base
+{
+protected:
+	pending_task_runner* const pool;
+
+	~scheduled_continuation() {}
+
+public:
+	explicit scheduled_continuation(pending_task_runner* pool_) : pool(pool_)
+	{}
+
+	void fire() override
+	{
+		if( pool )
+		{
+			pool->schedule(this);
+		}
+		else
+		{
+			run();
+		}
+	}
+
+	virtual void run() = 0;
+
+	/* The pool was shut down before it could run us */
+	virtual void abandon() = 0;
+};
+
+inline void pending_task_runner::schedule(scheduled_continuation* c)
+{
+	c->run();
+}
+
+/* What a pool's schedule() queues : runs the continuation, or abandons it if destroyed unrun */
+class continuation_task
+{
+	scheduled_continuation* c;
+
+public:
+	explicit continuation_task(scheduled_continuation* c_) : c(c_)
+	{}
+
+	continuation_task(continuation_task&& other) noexcept : c(other.c)
+	{
+		other.c = nullptr;
+	}
+
+	continuation_task(const continuation_task&) = delete;
+	continuation_task& operator = (const continuation_task&) = delete;
+
+	~continuation_task()
+	{
+		if( c )
+		{
+			c->abandon();
+		}
+	}
+
+	void operator () ()
+	{
+		scheduled_continuation* const p = c;
+		c = nullptr;
+		p->run();
+	}
+};
+
+class task_state_base
+{
+	enum { pending = 0, pending_with_waiters = 1, ready = 2 };
+
+	std::atomic<unsigned> status;
+	std::atomic<unsigned> references;
+	std::atomic<continuation_base*> continuation;
+
+protected:
+	std::exception_ptr error;
+
+	/* seq_cst, see set_continuation() */
+	void make_ready()
+	{
+		if( status.exchange(ready) == pending_with_waiters )
+		{
+			status.notify_all();
+		}
+		continuation_base* const c = continuation.exchange(nullptr);
+		if( c )
+		{
+			c->fire();
+		}
+	}
+
+	/* Destroys the most derived object and gives its memory back to the slab */
+	virtual void destroy() = 0;
+
+	virtual ~task_state_base() {}
+
+public:
+	explicit task_state_base(unsigned references_ = 2) :
+		status(pending), references(references_), continuation(nullptr)
+	{}
+
+	task_state_base(const task_state_base&) = delete;
+	task_state_base& operator = (const task_state_base&) = delete;
+
+	bool is_ready() const
+	{
+		return status.load(std::memory_order_acquire) == ready;
+	}
+
+	/* Block on the status word without helping */
+	void wait()
+	{
+		unsigned s = status.load(std::memory_order_acquire);
+		while( s != ready )
+		{
+			if( s == pending &&
+				!status.compare_exchange_weak(s, pending_with_waiters, std::memory_order_acquire) )
+			{
+				continue;	// s was reloaded
+			}
+			status.wait(pending_with_waiters, std::memory_order_acquire);
+			s = status.load(std::memory_order_acquire);
+		}
+	}
+
+	/*
+	 * Attach c, at most one per state. It fires when the state becomes ready, or right here if it
+	 * already is. We store c and then look at status, make_ready() stores status and then looks at
+	 * continuation, all seq_cst, so at least one of us sees both and the exchange lets only one fire c.
+	 * Once c is stored it may fire, run and drop the caller's reference on another thread, so we hold
+	 * one of our own until we are done looking at the state.
+	 */
+	void set_continuation(continuation_base* c)
+	{
+		add_reference();
+		continuation.store(c);
+		if( status.load() == ready )
+		{
+			continuation_base* const mine = continuation.exchange(nullptr);
+			if( mine )
+			{
+				mine->fire();
+			}
+		}
+		release();
+	}
+
+	void set_exception(std::exception_ptr e)
+	{
+		error = e;
+		make_ready();
+	}
+
+	void add_reference()
+	{
+		references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void release()
+	{
+		if( references.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+		{
+			destroy();
+		}
+	}
+};
+
+template<typename T>
+class task_state : public task_state_base
+{
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	bool has_value;
+
+	T& value()
+	{
+		return *std::launder(reinterpret_cast<T*>(&storage));
+	}
+
+	void destroy()
+	{
+		slab_delete(this);
+	}
+
+public:
+	explicit task_state(unsigned references_ = 2) : task_state_base(references_), has_value(false)
+	{}
+
+	~task_state()
+	{
+		if( has_value )
+		{
+			value().~T();
+		}
+	}
+
+	template<typename F>
+	void run(F& f)
+	{
+		::new (static_cast<void*>(&storage)) T(f());
+		has_value = true;
+		make_ready();
+	}
+
+	void set_value(T v)
+	{
+		::new (static_cast<void*>(&storage)) T(std::move(v));
+		has_value = true;
+		make_ready();
+	}
+
+	/* Only after is_ready() */
+	T take()
+	{
+		if( error )
+		{
+			std::rethrow_exception(error);
+		}
+		return std::move(value());
+	}
+};
+
+template<>
+class task_state<void> : public task_state_base
+{
+	void destroy()
+	{
+		slab_delete(this);
+	}
+
+public:
+	explicit task_state(unsigned references_ = 2) : task_state_base(references_)
+	{}
+
+	template<typename F>
+	void run(F& f)
+	{
+		f();
+		make_ready();
+	}
+
+	void set_value()
+	{
+		make_ready();
+	}
+
+	void take()
+	{
+		if( error )
+		{
+			std::rethrow_exception(error);
+		}
+	}
+};
+
+template<typename F, typename T, typename R>
+class then_continuation;
+
+template<typename T>
+class task_handle
+{
+	task_state<T>* state;
+	pending_task_runner* pool;
+
+public:
+	task_handle() : state(nullptr), pool(nullptr)
+	{}
+
+	/* Takes over one reference to state_ */
+	task_handle(task_state<T>* state_, pending_task_runner* pool_) : state(state_), pool(pool_)
+	{}
+
+	task_handle(task_handle&& other) : state(other.state), pool(other.pool)
+	{
+		other.state = nullptr;
+	}
+
+	task_handle& operator = (task_handle&& other)
+	{
+		if( this != &other )
+		{
+			if( state )
+			{
+				state->release();
+			}
+			state = other.state;
+			pool = other.pool;
+			other.state = nullptr;
+		}
+		return *this;
+	}
+
+	task_handle(const task_handle&) = delete;
+	task_handle& operator = (const task_handle&) = delete;
+
+	~task_handle()
+	{
+		if( state )
+		{
+			state->release();
+		}
+	}
+
+	bool valid() const
+	{
+		return state != nullptr;
+	}
+
+	bool is_ready() const
+	{
+		return state->is_ready();
+	}
+
+	/*
+	 * On a pool thread, run other pending tasks until ours is done. Once there is nothing left to
+	 * run our task is running on another worker, so spin briefly and then sleep on the status word.
+	 * Any other thread just sleeps.
+	 */
+	void wait()
+	{
+		if( pool && pool->is_pool_thread() )
+		{
+			idle_backoff backoff((idle_options()));
+			while( !state->is_ready() )
+			{
+				if( pool->run_pending_task() )
+				{
+					backoff.reset();
+				}
+				else if( !backoff.backoff() )
+				{
+					break;
+				}
+			}
+		}
+		state->wait();
+	}
+
+	/* Wait, then return the value or rethrow the exception. The handle is empty afterwards */
+	T get()
+	{
+		wait();
+		task_handle<T> done(std::move(*this));
+		return done.state->take();
+	}
+
+	/*
+	 * Consume the handle and return a handle to f(finished handle). f is queued on the pool once this
+	 * task is done; calling get() on its argument gives it the value or rethrows the exception.
+	 */
+	template<typename F>
+	task_handle<typename std::result_of<F(task_handle<T>)>::type> then(F f)
+	{
+		typedef typename std::result_of<F(task_handle<T>)>::type result_type;
+
+		task_state<result_type>* const result = slab_new<task_state<result_type>>();
+		task_state<T>* const antecedent = state;
+		state = nullptr;
+		antecedent->set_continuation(
+				slab_new<then_continuation<F, T, result_type>>(std::move(f), antecedent, result, pool));
+		return task_handle<result_type>(result, pool);
+	}
+
+	/* Used by the pool to build continuations and combinators on top of the state */
+	task_state<T>* native_state() const
+	{
+		return state;
+	}
+
+	pending_task_runner* native_pool() const
+	{
+		return pool;
+	}
+};
+
+/*
+ * The continuation behind task_handle<T>::then(). It owns the reference the consumed handle held
+ * on the antecedent, and one reference to the result.
+ */
+template<typename F, typename T, typename R>
+class then_continuation : public scheduled_continuation
+{
+	F f;
+	task_state<T>* antecedent;
+	task_state<R>* result;
+
+public:
+	then_continuation(F&& f_, task_state<T>* antecedent_, task_state<R>* result_, pending_task_runner* pool_) :
+		scheduled_continuation(pool_), f(std::move(f_)), antecedent(antecedent_), result(result_)
+	{}
+
+	void run() override
+	{
+		task_handle<T> finished(antecedent, pool);
+		task_state<R>* const r = result;
+		try
+		{
+			auto call = [this, &finished] { return f(std::move(finished)); };
+			r->run(call);
+		}
+		catch(...)
+		{
+			r->set_exception(std::current_exception());
+		}
+		slab_delete(this);
+		r->release();
+	}
+
+	void abandon() override
+	{
+		task_state<T>* const a = antecedent;
+		task_state<R>* const r = result;
+		slab_delete(this);
+		a->release();
+		r->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+		r->release();
+	}
+};
+
+/*
+ * The object that actually sits in the queue : the user's callable plus a reference to the state.
+ * Runs f, stores the value or exception, then drops its reference. If it is destroyed unrun, it
+ * breaks the promise so a waiter does not hang.
+ */
+template<typename F, typename T>
+class task_body
+{
+	F f;
+	task_state<T>* state;
+
+public:
+	task_body(F&& f_, task_state<T>* state_) : f(std::move(f_)), state(state_)
+	{}
+
+	task_body(task_body&& other) noexcept(std::is_nothrow_move_constructible<F>::value) :
+		f(std::move(other.f)), state(other.state)
+	{
+		other.state = nullptr;
+	}
+
+	task_body(const task_body&) = delete;
+	task_body& operator = (const task_body&) = delete;
+
+	~task_body()
+	{
+		if( state )
+		{
+			state->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+			state->release();
+		}
+	}
+
+	void operator () ()
+	{
+		task_state<T>* const s = state;
+		state = nullptr;
+		try
+		{
+			s->run(f);
+		}
+		catch(...)
+		{
+			s->set_exception(std::current_exception());
+		}
+		s->release();
+	}
+
+	/* Complete with e instead of running f */
+	void fail(std::exception_ptr e)
+	{
+		task_state<T>* const s = state;
+		state = nullptr;
+		s->set_exception(e);
+		s->release();
+	}
+};
+
+#endif /* TASK_HANDLE_CC */
@@ -0,0 +1,196 @@
+/*
+ * priority_thread_pool.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+All the pools so far run tasks in submission order, so a latency-sensitive request submitted behind
+a few thousand batch tasks waits for all of them.
+
+This pool has one queue ("lane") per priority level :
+1. submit(f, priority) pushes onto the lane for that priority.
+2. A worker takes from the highest non-empty lane.
+3. Strict priority would starve the low lanes for as long as high-priority work keeps coming, so
+   lanes age : every time a task is taken from a higher lane while a lower lane has work waiting,
+   the lower lane's passed_over count goes up. Once it reaches aging_limit, the next worker serves
+   that lane first and resets the count. With aging_limit = 8, a waiting low-priority task gets
+   at least one worker turn in every nine.
+Idle workers park on an eventcount (../7), submit() returns a task_handle<> (../10) and every lane
+is a lock-free mpmc_queue (../22).
+ */
+#ifndef PRIORITY_THREAD_POOL_CC
+#define PRIORITY_THREAD_POOL_CC
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+enum class task_priority : unsigned
+{
+	high = 0,
+	normal = 1,
+	low = 2
+};
+
+class priority_thread_pool : public pending_task_runner
+{
+	typedef function_wrapper task_type;
+
+	static unsigned const lane_count = 3;
+
+	struct lane
+	{
+		mpmc_queue<task_type> queue;
+		std::atomic<unsigned> passed_over;
+
+		lane() : passed_over(0)
+		{}
+	};
+
+	std::atomic_bool done;
+	unsigned const aging_limit;
+	idle_options const idle;
+	eventcount work_available;
+	lane lanes[lane_count];
+	std::vector<std::thread> threads;
+	join_threads joiner;
+
+	static thread_local priority_thread_pool* current_pool;
+
+	void worker_thread()
+	{
+		current_pool = this;
+
+		idle_backoff backoff(idle);
+		while( !done )
+		{
+			if( run_pending_task() )
+			{
+				backoff.reset();
+			}
+			else if( !backoff.backoff() )
+			{
+				work_available.wait([this] { return done || has_pending_work(); });
+				backoff.reset();
+			}
+		}
+		current_pool = nullptr;
+	}
+
+	bool has_pending_work() const
+	{
+		for( unsigned i = 0 ; i < lane_count ; i++ )
+		{
+			if( !lanes[i].queue.empty() )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool pop_task(task_type& task)
+	{
+		/* Aged lanes first, lowest priority first since it has been waiting longest */
+		for( unsigned i = lane_count ; i-- > 1 ; )
+		{
+			if( lanes[i].passed_over.load(std::memory_order_relaxed) >= aging_limit &&
+				lanes[i].queue.try_pop(task) )
+			{
+				lanes[i].passed_over.store(0, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		/* Then strict priority order, charging every waiting lower lane for being passed over */
+		for( unsigned i = 0 ; i < lane_count ; i++ )
+		{
+			if( lanes[i].queue.try_pop(task) )
+			{
+				for( unsigned j = i + 1 ; j < lane_count ; j++ )
+				{
+					if( !lanes[j].queue.empty() )
+					{
+						lanes[j].passed_over.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+public:
+	explicit priority_thread_pool(unsigned thread_count = std::max(std::thread::hardware_concurrency(), 1u),
+								  unsigned aging_limit_ = 8,
+								  idle_options idle_ = idle_options()) :
+		done(false), aging_limit(aging_limit_), idle(idle_), joiner(threads)
+	{
+		try
+		{
+			for( unsigned i = 0 ; i < thread_count ; i++ )
+			{
+				threads.push_back(std::thread(&priority_thread_pool::worker_thread, this));
+			}
+		}
+		catch(...)
+		{
+			done = true;
+			work_available.notify_all();
+			throw;
+		}
+	}
+
+	~priority_thread_pool()
+	{
+		done = true;
+		work_available.notify_all();
+	}
+
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(FunctionType f,
+																	  task_priority priority = task_priority::normal)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		lanes[static_cast<unsigned>(priority)].queue.push(
+				task_type(task_body<FunctionType, result_type>(std::move(f), state)));
+		work_available.notify_one();
+		return task_handle<result_type>(state, this);
+	}
+
+	bool run_pending_task() override
+	{
+		task_type task;
+		if( pop_task(task) )
+		{
+			task();
+			return true;
+		}
+		return false;
+	}
+
+	/* Continuations run at normal priority */
+	void schedule(scheduled_continuation* c) override
+	{
+		if( done )
+		{
+			c->abandon();
+			return;
+		}
+		lanes[static_cast<unsigned>(task_priority::normal)].queue.push(task_type(continuation_task(c)));
+		work_available.notify_one();
+	}
+
+	bool is_pool_thread() const override
+	{
+		return current_pool == this;
+	}
+};
+
+thread_local priority_thread_pool* priority_thread_pool::current_pool = nullptr;
+
+#endif /* PRIORITY_THREAD_POOL_CC */
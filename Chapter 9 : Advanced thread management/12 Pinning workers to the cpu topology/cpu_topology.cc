@@ -0,0 +1,270 @@
+/*
+ * cpu_topology.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The pools start hardware_concurrency() threads and leave it to the OS where they run. The scheduler
+migrates them between cores, and a worker's deque, whose tasks were pushed while their data was hot
+in that core's L1/L2, ends up being served from a cold cache.
+
+cpu_topology reads the Linux sysfs description of the machine :
+	/sys/devices/system/cpu/cpuN/topology/thread_siblings_list	SMT siblings (same physical core)
+	/sys/devices/system/cpu/cpuN/topology/physical_package_id	socket
+	/sys/devices/system/cpu/cpuN/cache/indexK/{level,shared_cpu_list}	which cpus share each cache
+and restricts it to the cpus in the process affinity mask (sched_getaffinity), so running under
+"taskset -c 0-3" gives a 4-cpu topology.
+
+It provides :
+1. worker_cpus(n) : the cpus to pin n workers to. It takes one cpu per physical core first and
+   only then the SMT siblings, so a pool smaller than the machine does not put two workers on
+   one core. Siblings outside the affinity mask do not count : under "taskset -c 2,3,5" on a
+   2-way SMT box with cores (0,1), (2,3), (4,5), cpu 5 is the first thread of its core.
+2. distance(a, b) : 0 same cpu, 1 SMT sibling, 2 shared L2, 3 shared L3, 4 same socket, 5 remote.
+   The pool uses it to order its steal victims nearest first.
+3. pin_current_thread(cpu).
+A topology can also be described by hand (cores and allowed cpus), to try placement without the
+hardware. On other systems there is no topology information, and every cpu is equally far from every other.
+ */
+#ifndef CPU_TOPOLOGY_CC
+#define CPU_TOPOLOGY_CC
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+class cpu_topology
+{
+	struct cpu_info
+	{
+		unsigned cpu;
+		int package;
+		std::vector<unsigned> smt_siblings;		// sorted, includes cpu itself
+		std::vector<unsigned> l2_sharers;
+		std::vector<unsigned> l3_sharers;
+	};
+
+	std::vector<cpu_info> cpus;		// only the cpus we are allowed to run on
+
+	/* Parse a sysfs cpu list such as "0-3,8,10-11" */
+	static std::vector<unsigned> parse_cpu_list(std::string const& text)
+	{
+		std::vector<unsigned> result;
+		std::stringstream stream(text);
+		std::string range;
+		while( std::getline(stream, range, ',') )
+		{
+			if( range.empty() || range[0] == '\n' )
+			{
+				continue;
+			}
+			std::string::size_type const dash = range.find('-');
+			unsigned const first = std::stoul(range.substr(0, dash));
+			unsigned const last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+			for( unsigned cpu = first ; cpu <= last ; cpu++ )
+			{
+				result.push_back(cpu);
+			}
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	static std::string read_file(std::string const& path)
+	{
+		std::ifstream file(path.c_str());
+		std::string text;
+		std::getline(file, text);
+		return text;
+	}
+
+	static bool contains(std::vector<unsigned> const& cpu_set, unsigned cpu)
+	{
+		return std::binary_search(cpu_set.begin(), cpu_set.end(), cpu);
+	}
+
+	cpu_info const* find(unsigned cpu) const
+	{
+		for( unsigned i = 0 ; i < cpus.size() ; i++ )
+		{
+			if( cpus[i].cpu == cpu )
+			{
+				return &cpus[i];
+			}
+		}
+		return nullptr;
+	}
+
+	void load(unsigned cpu)
+	{
+		std::string const base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+
+		cpu_info info;
+		info.cpu = cpu;
+		std::string const package = read_file(base + "/topology/physical_package_id");
+		info.package = package.empty() ? 0 : std::stoi(package);
+		info.smt_siblings = parse_cpu_list(read_file(base + "/topology/thread_siblings_list"));
+
+		for( unsigned index = 0 ; ; index++ )
+		{
+			std::string const cache = base + "/cache/index" + std::to_string(index);
+			std::string const level = read_file(cache + "/level");
+			if( level.empty() )
+			{
+				break;
+			}
+			if( level == "2" )
+			{
+				info.l2_sharers = parse_cpu_list(read_file(cache + "/shared_cpu_list"));
+			}
+			else if( level == "3" )
+			{
+				info.l3_sharers = parse_cpu_list(read_file(cache + "/shared_cpu_list"));
+			}
+		}
+		cpus.push_back(info);
+	}
+
+public:
+	cpu_topology()
+	{
+#ifdef __linux__
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		if( sched_getaffinity(0, sizeof(mask), &mask) == 0 )
+		{
+			for( unsigned cpu = 0 ; cpu < CPU_SETSIZE ; cpu++ )
+			{
+				if( CPU_ISSET(cpu, &mask) )
+				{
+					load(cpu);
+				}
+			}
+		}
+#endif
+		if( cpus.empty() )
+		{
+			/* No sysfs : pretend every cpu is its own core on one socket */
+			for( unsigned cpu = 0 ; cpu < std::max(std::thread::hardware_concurrency(), 1u) ; cpu++ )
+			{
+				cpu_info info;
+				info.cpu = cpu;
+				info.package = 0;
+				info.smt_siblings.push_back(cpu);
+				cpus.push_back(info);
+			}
+		}
+	}
+
+	/* A made-up machine on one socket : cores lists the SMT siblings of each core, allowed is the mask */
+	cpu_topology(std::vector<std::vector<unsigned>> const& cores, std::vector<unsigned> const& allowed)
+	{
+		for( unsigned i = 0 ; i < cores.size() ; i++ )
+		{
+			std::vector<unsigned> siblings = cores[i];
+			std::sort(siblings.begin(), siblings.end());
+			for( unsigned j = 0 ; j < siblings.size() ; j++ )
+			{
+				if( std::find(allowed.begin(), allowed.end(), siblings[j]) != allowed.end() )
+				{
+					cpu_info info;
+					info.cpu = siblings[j];
+					info.package = 0;
+					info.smt_siblings = siblings;
+					cpus.push_back(info);
+				}
+			}
+		}
+	}
+
+	/* Number of cpus in the affinity mask */
+	unsigned size() const
+	{
+		return static_cast<unsigned>(cpus.size());
+	}
+
+	unsigned distance(unsigned a, unsigned b) const
+	{
+		if( a == b )
+		{
+			return 0;
+		}
+		cpu_info const* const info = find(a);
+		if( !info )
+		{
+			return 5;
+		}
+		if( contains(info->smt_siblings, b) )
+		{
+			return 1;
+		}
+		if( contains(info->l2_sharers, b) )
+		{
+			return 2;
+		}
+		if( contains(info->l3_sharers, b) )
+		{
+			return 3;
+		}
+		cpu_info const* const other = find(b);
+		return other && other->package == info->package ? 4 : 5;
+	}
+
+	/*
+	 * cpus for n workers : the first SMT thread of every core, then the second, and so on. Wraps round
+	 * if there are more workers than cpus.
+	 */
+	std::vector<unsigned> worker_cpus(unsigned n) const
+	{
+		/*
+		 * (position among its SMT siblings in the mask, cpu) sorts all first threads ahead of all second
+		 * threads. A sibling we may not run on leaves its core's next thread first
+		 */
+		std::vector<std::pair<unsigned, unsigned>> ranked;
+		for( unsigned i = 0 ; i < cpus.size() ; i++ )
+		{
+			std::vector<unsigned> const& siblings = cpus[i].smt_siblings;
+			unsigned rank = 0;
+			for( unsigned j = 0 ; j < siblings.size() && siblings[j] < cpus[i].cpu ; j++ )
+			{
+				if( find(siblings[j]) )
+				{
+					rank++;
+				}
+			}
+			ranked.push_back(std::make_pair(rank, cpus[i].cpu));
+		}
+		std::sort(ranked.begin(), ranked.end());
+
+		std::vector<unsigned> result;
+		for( unsigned i = 0 ; i < n ; i++ )
+		{
+			result.push_back(ranked[i % ranked.size()].second);
+		}
+		return result;
+	}
+
+	/* Returns false if the OS refused (or there is no way to pin on this platform) */
+	static bool pin_current_thread(unsigned cpu)
+	{
+#ifdef __linux__
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		CPU_SET(cpu, &mask);
+		return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+#else
+		(void)cpu;
+		return false;
+#endif
+	}
+};
+
+#endif /* CPU_TOPOLOGY_CC */
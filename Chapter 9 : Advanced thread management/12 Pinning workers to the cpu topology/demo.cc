@@ -0,0 +1,137 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Prints the topology the pool sees, and where workers go on a described 2-way SMT machine with a
+ * restricted mask, then compares an unpinned and a pinned work-stealing pool on
+ * the same job.
+ *
+ * The job repeatedly sweeps a working set that fits in the sum of the caches, splitting it
+ * recursively with submit() (the same divide and conquer shape as the quicksort in ../6). Every pass
+ * splits the range the same way, so a worker that stays on its cpu tends to meet the same halves
+ * again while they are still in its L1/L2. Unpinned workers migrate, and their thieves take from
+ * any queue, so more of every pass comes from L3 or memory.
+ *
+ * The affinity mask is respected, so the topology can be tried on one box, e.g.
+ *		taskset -c 0-3 ./demo			four cpus, whatever they are
+ *		taskset -c 0,2,4,6 ./demo		one thread of each of four cores on a 2-way SMT machine
+ * On a single cpu both pools behave the same and the numbers only show the pinning overhead.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+void print_topology()
+{
+	cpu_topology topology;
+	std::vector<unsigned> const cpus = topology.worker_cpus(topology.size());
+
+	std::cout << topology.size() << " cpus in the affinity mask, workers go to :";
+	for( unsigned i = 0 ; i < cpus.size() ; i++ )
+	{
+		std::cout << " " << cpus[i];
+	}
+	std::cout << std::endl;
+
+	/* A distance matrix is only readable for small masks */
+	if( cpus.size() > 16 )
+	{
+		return;
+	}
+	std::cout << "distance (0 same, 1 SMT, 2 L2, 3 L3, 4 socket, 5 remote) :" << std::endl;
+	for( unsigned i = 0 ; i < cpus.size() ; i++ )
+	{
+		std::cout << "  cpu " << cpus[i] << " :";
+		for( unsigned j = 0 ; j < cpus.size() ; j++ )
+		{
+			std::cout << " " << topology.distance(cpus[i], cpus[j]);
+		}
+		std::cout << std::endl;
+	}
+}
+
+/* Cores (0,1), (2,3), (4,5) under "taskset -c 2,3,5" : two workers belong on two cores, 2 and 5 */
+void print_masked_example()
+{
+	std::vector<std::vector<unsigned>> const cores = { { 0, 1 }, { 2, 3 }, { 4, 5 } };
+	cpu_topology const topology(cores, { 2, 3, 5 });
+	std::vector<unsigned> const cpus = topology.worker_cpus(2);
+	std::cout << "cores (0,1) (2,3) (4,5), mask 2,3,5, 2 workers go to :";
+	for( unsigned i = 0 ; i < cpus.size() ; i++ )
+	{
+		std::cout << " " << cpus[i];
+	}
+	std::cout << std::endl;
+}
+
+/* Sum of data[first, last), split in halves down to grain elements, one half submitted each time */
+long sweep(thread_pool& pool, std::vector<long> const& data, std::size_t first, std::size_t last, std::size_t grain)
+{
+	if( last - first <= grain )
+	{
+		long sum = 0;
+		for( std::size_t i = first ; i < last ; i++ )
+		{
+			sum += data[i];
+		}
+		return sum;
+	}
+
+	std::size_t const middle = first + (last - first) / 2;
+	task_handle<long> lower = pool.submit([&pool, &data, first, middle, grain]
+	{
+		return sweep(pool, data, first, middle, grain);
+	});
+	long const upper = sweep(pool, data, middle, last, grain);
+	return lower.get() + upper;
+}
+
+void measure(char const* name, worker_placement placement, std::vector<long> const& data, unsigned passes)
+{
+	thread_pool pool(std::max(std::thread::hardware_concurrency(), 1u), idle_options(), placement);
+	long const expected = static_cast<long>(data.size()) * (static_cast<long>(data.size()) - 1) / 2;
+
+	clock_type::time_point const start = clock_type::now();
+	bool ok = true;
+	for( unsigned pass = 0 ; pass < passes ; pass++ )
+	{
+		/* Run the top level on the pool so the split starts from a worker's own deque */
+		long const sum = pool.submit([&pool, &data] { return sweep(pool, data, 0, data.size(), 4096); }).get();
+		ok = ok && sum == expected;
+	}
+	clock_type::time_point const stop = clock_type::now();
+
+	double const seconds = std::chrono::duration<double>(stop - start).count();
+	std::cout << name << " : " << passes / seconds << " passes/s, "
+			  << data.size() * passes * sizeof(long) / seconds / 1e9 << " GB/s"
+			  << (ok ? "" : " WRONG RESULT") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	/* Default working set 4 MB, about the L2 of a few cores */
+	std::size_t const length = argc > 1 ? std::atol(argv[1]) : (1 << 19);
+	unsigned const passes = argc > 2 ? std::atoi(argv[2]) : 500;
+
+	print_topology();
+	print_masked_example();
+
+	std::vector<long> data(length);
+	for( std::size_t i = 0 ; i < length ; i++ )
+	{
+		data[i] = static_cast<long>(i);
+	}
+
+	measure("unpinned", worker_placement::unpinned, data, passes);
+	measure("pinned  ", worker_placement::pinned, data, passes);
+	return 0;
+}
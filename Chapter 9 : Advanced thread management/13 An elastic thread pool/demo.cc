@@ -0,0 +1,57 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Bursty traffic against an elastic_thread_pool with 1 to 32 workers. Every burst submits 400
+ * tasks that block for 1 ms (standing in for I/O), then the load goes quiet for a while. During a
+ * burst the pool grows until tasks stop waiting; in the quiet period the extra workers retire
+ * after idle_timeout.
+ * Each line shows the workers alive at the end of a burst and after the quiet period, plus how long
+ * the burst took. The last line is stats().
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "elastic_thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+int main(int argc, char **argv)
+{
+	elastic_options options(1, 32, 8, std::chrono::milliseconds(2), std::chrono::milliseconds(100));
+	elastic_thread_pool pool(options);
+
+	for( unsigned burst = 0 ; burst < 4 ; burst++ )
+	{
+		clock_type::time_point const start = clock_type::now();
+
+		std::vector<task_handle<void>> handles;
+		for( unsigned i = 0 ; i < 400 ; i++ )
+		{
+			handles.push_back(pool.submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }));
+		}
+		for( unsigned i = 0 ; i < handles.size() ; i++ )
+		{
+			handles[i].get();
+		}
+
+		clock_type::time_point const stop = clock_type::now();
+		unsigned const busy_workers = pool.stats().workers;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		std::cout << "burst " << burst << " : "
+				  << std::chrono::duration<double, std::milli>(stop - start).count() << " ms, "
+				  << busy_workers << " workers after the burst, "
+				  << pool.stats().workers << " after the quiet period" << std::endl;
+	}
+
+	scaling_stats const s = pool.stats();
+	std::cout << "peak " << s.peak_workers << " workers, spawned for queue depth " << s.spawned_for_queue_depth
+			  << ", for sojourn time " << s.spawned_for_sojourn << ", retired idle " << s.retired_idle << std::endl;
+	return 0;
+}
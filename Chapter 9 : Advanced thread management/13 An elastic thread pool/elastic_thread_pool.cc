@@ -0,0 +1,376 @@
+/*
+ * elastic_thread_pool.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+Every pool so far starts a fixed number of threads in its constructor and keeps them until it is
+destroyed. With bursty traffic that is wrong both ways : off-peak the threads (and their stacks) sit
+idle, and in a burst of blocking tasks there are not enough of them.
+
+elastic_thread_pool keeps between min_threads and max_threads workers :
+1. Grow on queue depth : submit() starts a new worker when no worker is idle and at least
+   grow_queue_depth tasks are queued.
+2. Grow on sojourn time : every queued task carries its enqueue time. A worker that pops a task
+   which waited longer than grow_sojourn, while no worker is idle, starts another worker.
+3. Shrink on idleness : an idle worker spins and yields as in ../7, then sleeps on a condition
+   variable for at most idle_timeout. If it times out with nothing to do and there are more than
+   min_threads workers, it retires. A retired thread is joined by the next thread that starts a
+   worker, or by the destructor.
+4. stats() returns how many workers there are, the peak, and how often each rule fired.
+The idle sleep uses a condition variable rather than the eventcount, since the wait needs a timeout.
+Tasks go to a single shared queue, as in ../2. The work-stealing pool in ../6 indexes its deques
+without a lock, so it cannot add or remove deques while running.
+ */
+#ifndef ELASTIC_THREAD_POOL_CC
+#define ELASTIC_THREAD_POOL_CC
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+struct elastic_options
+{
+	unsigned min_threads;						// never fewer workers than this (at least 1)
+	unsigned max_threads;						// never more workers than this
+	std::size_t grow_queue_depth;				// queued tasks that trigger a new worker
+	std::chrono::microseconds grow_sojourn;		// queueing delay that triggers a new worker
+	std::chrono::milliseconds idle_timeout;		// how long an idle worker sleeps before it retires
+	idle_options idle;							// spinning before the sleep
+
+	elastic_options(unsigned min_threads_ = 1,
+					unsigned max_threads_ = std::max(std::thread::hardware_concurrency(), 1u),
+					std::size_t grow_queue_depth_ = 16,
+					std::chrono::microseconds grow_sojourn_ = std::chrono::milliseconds(1),
+					std::chrono::milliseconds idle_timeout_ = std::chrono::seconds(2)) :
+		min_threads(std::max(min_threads_, 1u)), max_threads(std::max(max_threads_, min_threads)),
+		grow_queue_depth(grow_queue_depth_), grow_sojourn(grow_sojourn_), idle_timeout(idle_timeout_)
+	{}
+};
+
+/* Snapshot returned by elastic_thread_pool::stats() */
+struct scaling_stats
+{
+	unsigned workers;
+	unsigned peak_workers;
+	unsigned long spawned_for_queue_depth;
+	unsigned long spawned_for_sojourn;
+	unsigned long retired_idle;
+};
+
+class elastic_thread_pool : public pending_task_runner
+{
+	typedef std::chrono::steady_clock clock_type;
+
+	struct queued_task
+	{
+		function_wrapper task;
+		clock_type::time_point enqueued;
+	};
+
+	enum class grow_reason { queue_depth, sojourn };
+
+	elastic_options const options;
+	std::atomic_bool done;
+	thread_safe_queue<queued_task> work_queue;
+	std::atomic<std::size_t> queued;			// tasks in work_queue
+
+	/* Idle workers sleep on work_available, idle_workers is only changed under idle_mutex */
+	std::mutex idle_mutex;
+	std::condition_variable work_available;
+	std::atomic<unsigned> idle_workers;
+
+	/* Worker count, reserved before a thread is started and released when it retires */
+	std::atomic<unsigned> worker_count;
+
+	/* live holds every running worker's std::thread, finished the ones that retired but are not joined */
+	std::mutex threads_mutex;
+	std::map<std::thread::id, std::thread> live;
+	std::vector<std::thread> finished;
+
+	std::atomic<unsigned> peak_workers;
+	std::atomic<unsigned long> spawned_for_queue_depth;
+	std::atomic<unsigned long> spawned_for_sojourn;
+	std::atomic<unsigned long> retired_idle;
+
+	static thread_local elastic_thread_pool* current_pool;
+
+	void worker_thread()
+	{
+		current_pool = this;
+
+		idle_backoff backoff(options.idle);
+		while( !done )
+		{
+			if( run_pending_task() )
+			{
+				backoff.reset();
+			}
+			else if( !backoff.backoff() )
+			{
+				if( !park() && try_retire() )
+				{
+					break;
+				}
+				backoff.reset();
+			}
+		}
+
+		current_pool = nullptr;
+		leave();
+	}
+
+	/* Sleep until there is work or we are shutting down. False if idle_timeout expired first */
+	bool park()
+	{
+		std::unique_lock<std::mutex> lk(idle_mutex);
+		idle_workers++;
+		bool const woken = work_available.wait_for(lk, options.idle_timeout, [this]
+		{
+			return done || queued.load() != 0;
+		});
+		idle_workers--;
+		return woken;
+	}
+
+	bool try_retire()
+	{
+		unsigned count = worker_count.load();
+		while( count > options.min_threads )
+		{
+			if( worker_count.compare_exchange_weak(count, count - 1) )
+			{
+				retired_idle.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* Hand our own std::thread over to be joined. The destructor may already have taken it */
+	void leave()
+	{
+		std::lock_guard<std::mutex> lk(threads_mutex);
+		std::map<std::thread::id, std::thread>::iterator const self = live.find(std::this_thread::get_id());
+		if( self != live.end() )
+		{
+			finished.push_back(std::move(self->second));
+			live.erase(self);
+		}
+	}
+
+	/* Start one more worker unless we are at max_threads */
+	void try_grow(grow_reason reason)
+	{
+		unsigned count = worker_count.load();
+		do
+		{
+			if( count >= options.max_threads )
+			{
+				return;
+			}
+		}
+		while( !worker_count.compare_exchange_weak(count, count + 1) );
+
+		/* Running out of threads is not the submitter's problem, the existing workers carry on */
+		bool started = false;
+		try
+		{
+			started = start_worker();
+		}
+		catch(std::system_error const&)
+		{}
+		if( !started )
+		{
+			worker_count--;
+			return;
+		}
+
+		std::atomic<unsigned long>& counter =
+				reason == grow_reason::queue_depth ? spawned_for_queue_depth : spawned_for_sojourn;
+		counter.fetch_add(1, std::memory_order_relaxed);
+
+		unsigned peak = peak_workers.load(std::memory_order_relaxed);
+		while( peak < count + 1 && !peak_workers.compare_exchange_weak(peak, count + 1, std::memory_order_relaxed) )
+		{}
+	}
+
+	/* The caller has already counted the worker in worker_count */
+	bool start_worker()
+	{
+		std::vector<std::thread> to_join;
+		{
+			std::lock_guard<std::mutex> lk(threads_mutex);
+			if( done )
+			{
+				return false;
+			}
+			/* Still holding the lock, so the new worker cannot leave() before it is in live */
+			std::thread worker(&elastic_thread_pool::worker_thread, this);
+			std::thread::id const id = worker.get_id();
+			live[id] = std::move(worker);
+			to_join.swap(finished);
+		}
+
+		/* Retired workers have nothing left to do but return */
+		for( unsigned i = 0 ; i < to_join.size() ; i++ )
+		{
+			to_join[i].join();
+		}
+		return true;
+	}
+
+	void wake_one()
+	{
+		if( idle_workers.load() != 0 )
+		{
+			std::lock_guard<std::mutex> lk(idle_mutex);
+			work_available.notify_one();
+		}
+	}
+
+	/* Wake an idle worker, or grow if there is none and the queue is deep */
+	void enqueue(function_wrapper task)
+	{
+		work_queue.push(queued_task{std::move(task), clock_type::now()});
+		std::size_t const depth = ++queued;
+
+		if( idle_workers.load() == 0 )
+		{
+			if( depth >= options.grow_queue_depth )
+			{
+				try_grow(grow_reason::queue_depth);
+			}
+		}
+		else
+		{
+			wake_one();
+		}
+	}
+
+	bool pop_task(function_wrapper& task)
+	{
+		queued_task item;
+		if( !work_queue.try_pop(item) )
+		{
+			return false;
+		}
+		queued--;
+
+		if( clock_type::now() - item.enqueued > options.grow_sojourn && idle_workers.load() == 0 )
+		{
+			try_grow(grow_reason::sojourn);
+		}
+		task = std::move(item.task);
+		return true;
+	}
+
+	void shut_down()
+	{
+		done = true;
+		{
+			std::lock_guard<std::mutex> lk(idle_mutex);
+			work_available.notify_all();
+		}
+
+		/* start_worker() checks done under threads_mutex, so nothing is added to live after this */
+		std::vector<std::thread> to_join;
+		{
+			std::lock_guard<std::mutex> lk(threads_mutex);
+			to_join.swap(finished);
+			for( std::map<std::thread::id, std::thread>::iterator it = live.begin() ; it != live.end() ; ++it )
+			{
+				to_join.push_back(std::move(it->second));
+			}
+			live.clear();
+		}
+		for( unsigned i = 0 ; i < to_join.size() ; i++ )
+		{
+			to_join[i].join();
+		}
+	}
+
+public:
+	explicit elastic_thread_pool(elastic_options options_ = elastic_options()) :
+		options(options_), done(false), queued(0), idle_workers(0), worker_count(0), peak_workers(0),
+		spawned_for_queue_depth(0), spawned_for_sojourn(0), retired_idle(0)
+	{
+		try
+		{
+			for( unsigned i = 0 ; i < options.min_threads ; i++ )
+			{
+				worker_count++;
+				start_worker();
+			}
+			peak_workers = worker_count.load();
+		}
+		catch(...)
+		{
+			shut_down();
+			throw;
+		}
+	}
+
+	~elastic_thread_pool()
+	{
+		shut_down();
+	}
+
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(FunctionType f)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		enqueue(function_wrapper(task_body<FunctionType, result_type>(std::move(f), state)));
+		return task_handle<result_type>(state, this);
+	}
+
+	bool run_pending_task() override
+	{
+		function_wrapper task;
+		if( pop_task(task) )
+		{
+			task();
+			return true;
+		}
+		return false;
+	}
+
+	void schedule(scheduled_continuation* c) override
+	{
+		if( done )
+		{
+			c->abandon();
+			return;
+		}
+		enqueue(function_wrapper(continuation_task(c)));
+	}
+
+	bool is_pool_thread() const override
+	{
+		return current_pool == this;
+	}
+
+	scaling_stats stats() const
+	{
+		scaling_stats s;
+		s.workers = worker_count.load(std::memory_order_relaxed);
+		s.peak_workers = peak_workers.load(std::memory_order_relaxed);
+		s.spawned_for_queue_depth = spawned_for_queue_depth.load(std::memory_order_relaxed);
+		s.spawned_for_sojourn = spawned_for_sojourn.load(std::memory_order_relaxed);
+		s.retired_idle = retired_idle.load(std::memory_order_relaxed);
+		return s;
+	}
+};
+
+thread_local elastic_thread_pool* elastic_thread_pool::current_pool = nullptr;
+
+#endif /* ELASTIC_THREAD_POOL_CC */
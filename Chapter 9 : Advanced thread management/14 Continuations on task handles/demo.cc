@@ -0,0 +1,112 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Three algorithms on the work-stealing pool where no worker ever waits for another task. The only
+ * get() is the one in main() on the final handle.
+ * 1. A recursive sum : each level joins its two halves with when_all() and adds them in then().
+ * 2. A merge sort : the leaves are std::sort tasks, and each merge is a then() on when_all() of the
+ *    two halves. Compare with ../4 and ../6, where do_sort() sits in get() until its lower half is done.
+ * 3. when_any() : two "replicas" answer the same query after different delays, take the first.
+ * The last line shows an exception from a leaf coming out of get() at the top of the chain.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "when_all.cc"
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+template<typename Iterator>
+task_handle<long> sum_async(thread_pool& pool, Iterator first, Iterator last)
+{
+	std::size_t const length = std::distance(first, last);
+	if( length <= 10000 )
+	{
+		return pool.submit([first, last] { return std::accumulate(first, last, 0l); });
+	}
+
+	Iterator const middle = first + length / 2;
+	std::vector<task_handle<long>> halves;
+	halves.push_back(sum_async(pool, first, middle));
+	halves.push_back(sum_async(pool, middle, last));
+	return when_all(std::move(halves)).then([](task_handle<std::vector<task_handle<long>>> both)
+	{
+		std::vector<task_handle<long>> halves = both.get();
+		return halves[0].get() + halves[1].get();
+	});
+}
+
+task_handle<void> sort_async(thread_pool& pool, std::vector<int>& data, std::size_t first, std::size_t last)
+{
+	if( last - first <= 10000 )
+	{
+		return pool.submit([&data, first, last] { std::sort(data.begin() + first, data.begin() + last); });
+	}
+
+	std::size_t const middle = first + (last - first) / 2;
+	std::vector<task_handle<void>> halves;
+	halves.push_back(sort_async(pool, data, first, middle));
+	halves.push_back(sort_async(pool, data, middle, last));
+	return when_all(std::move(halves)).then([&data, first, middle, last](task_handle<std::vector<task_handle<void>>> both)
+	{
+		std::vector<task_handle<void>> halves = both.get();
+		halves[0].get();
+		halves[1].get();
+		std::inplace_merge(data.begin() + first, data.begin() + middle, data.begin() + last);
+	});
+}
+
+int main(int argc, char **argv)
+{
+	std::size_t const length = argc > 1 ? std::atol(argv[1]) : 1000000;
+	thread_pool pool;
+
+	std::vector<long> numbers(length);
+	std::iota(numbers.begin(), numbers.end(), 0);
+	long const sum = sum_async(pool, numbers.begin(), numbers.end()).get();
+	std::cout << "sum " << sum << (sum == std::accumulate(numbers.begin(), numbers.end(), 0l) ? " ok" : " WRONG")
+			  << std::endl;
+
+	std::vector<int> data(length);
+	for( std::size_t i = 0 ; i < length ; i++ )
+	{
+		data[i] = std::rand();
+	}
+	clock_type::time_point const start = clock_type::now();
+	sort_async(pool, data, 0, data.size()).get();
+	clock_type::time_point const stop = clock_type::now();
+	std::cout << "sorted " << length << " elements in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms"
+			  << (std::is_sorted(data.begin(), data.end()) ? ", ok" : ", NOT SORTED") << std::endl;
+
+	/* Own pool with a thread per replica, so both are in flight even on a single cpu */
+	thread_pool replica_pool(2);
+	std::vector<task_handle<char const*>> replicas;
+	replicas.push_back(replica_pool.submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(50)); return "slow replica"; }));
+	replicas.push_back(replica_pool.submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(5)); return "fast replica"; }));
+	when_any_result<char const*> first = when_any(std::move(replicas)).get();
+	std::cout << "first answer from " << first.handles[first.index].get() << std::endl;
+
+	task_handle<int> failing = pool.submit([]() -> int { throw std::runtime_error("leaf failed"); })
+			.then([](task_handle<int> leaf) { return leaf.get() + 1; });
+	try
+	{
+		failing.get();
+	}
+	catch(std::exception const& e)
+	{
+		std::cout << "exception through then() : " << e.what() << std::endl;
+	}
+	return 0;
+}
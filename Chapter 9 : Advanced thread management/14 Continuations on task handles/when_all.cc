@@ -0,0 +1,192 @@
+/*
+ * when_all.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+parallel_accumulate in ../3 and do_sort() in ../4 wait for their sub-tasks with get(). That blocks
+the caller, or, on a pool thread, buries it in run_pending_task() calls until the sub-task is done.
+With task_handle<T>::then() (../10) the work that needs the result is queued instead, and this file
+adds the two combinators needed to join several tasks without waiting :
+1. when_all(handles) : a task_handle<std::vector<task_handle<T>>> that becomes ready once every
+   handle in the vector is ready. The handles come back inside it, all finished, so get() on each
+   returns its value or rethrows its exception.
+2. when_any(handles) : a task_handle<when_any_result<T>> that becomes ready as soon as one handle is
+   ready, with its index and all the handles.
+Neither runs user code, so their continuations do a little counting right on the thread that
+finished the task instead of being queued on the pool. The result handle gets the pool of the first
+input, so waiting on it from a pool thread still helps.
+ */
+#ifndef WHEN_ALL_CC
+#define WHEN_ALL_CC
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "../10 Pool-native task handles/task_handle.cc"
+
+template<typename T>
+class when_all_state
+{
+	typedef std::vector<task_handle<T>> handles_type;
+
+	struct input : public continuation_base
+	{
+		when_all_state* owner;
+
+		void fire() override
+		{
+			owner->input_ready();
+		}
+	};
+
+	handles_type handles;
+	std::vector<input> inputs;					// one continuation per handle, never reallocated
+	task_state<handles_type>* result;
+	std::atomic<std::size_t> remaining;			// inputs not ready yet, plus one while attaching
+
+	/* The last one to arrive hands the handles over and frees us */
+	void input_ready()
+	{
+		if( remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+		{
+			task_state<handles_type>* const r = result;
+			handles_type finished(std::move(handles));
+			slab_delete(this);
+			r->set_value(std::move(finished));
+			r->release();
+		}
+	}
+
+public:
+	when_all_state(handles_type&& handles_, task_state<handles_type>* result_) :
+		handles(std::move(handles_)), inputs(handles.size()), result(result_), remaining(handles.size() + 1)
+	{}
+
+	static task_handle<handles_type> start(handles_type handles_)
+	{
+		pending_task_runner* const pool = handles_.empty() ? nullptr : handles_[0].native_pool();
+		task_state<handles_type>* const result = slab_new<task_state<handles_type>>();
+
+		/* Count ourselves in remaining, so nothing completes before every continuation is attached */
+		when_all_state* const state = slab_new<when_all_state>(std::move(handles_), result);
+		std::size_t const count = state->handles.size();
+		for( std::size_t i = 0 ; i < count ; i++ )
+		{
+			state->inputs[i].owner = state;
+			state->handles[i].native_state()->set_continuation(&state->inputs[i]);
+		}
+		state->input_ready();
+
+		return task_handle<handles_type>(result, pool);
+	}
+};
+
+template<typename T>
+task_handle<std::vector<task_handle<T>>> when_all(std::vector<task_handle<T>> handles)
+{
+	return when_all_state<T>::start(std::move(handles));
+}
+
+template<typename T>
+struct when_any_result
+{
+	std::size_t index;						// first handle that became ready, or npos if there were none
+	std::vector<task_handle<T>> handles;
+
+	static std::size_t const npos = static_cast<std::size_t>(-1);
+};
+
+template<typename T>
+class when_any_state
+{
+	typedef std::vector<task_handle<T>> handles_type;
+
+	struct input : public continuation_base
+	{
+		when_any_state* owner;
+		std::size_t index;
+
+		void fire() override
+		{
+			owner->input_ready(index);
+		}
+	};
+
+	handles_type handles;
+	std::vector<input> inputs;
+	task_state<when_any_result<T>>* result;
+	std::atomic<std::size_t> winner;
+
+	/*
+	 * The result needs a winner and every continuation attached, since it takes the handles away.
+	 * Both the winner and start() pass this gate, the second one through delivers.
+	 */
+	std::atomic<unsigned> gate;
+
+	/* Inputs that have not fired yet, plus start(). The last one out frees us */
+	std::atomic<std::size_t> references;
+
+	void pass_gate()
+	{
+		if( gate.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+		{
+			when_any_result<T> finished;
+			finished.index = winner.load(std::memory_order_relaxed);
+			finished.handles = std::move(handles);
+			result->set_value(std::move(finished));
+			result->release();
+		}
+	}
+
+	void release()
+	{
+		if( references.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+		{
+			slab_delete(this);
+		}
+	}
+
+	void input_ready(std::size_t index)
+	{
+		std::size_t expected = when_any_result<T>::npos;
+		if( winner.compare_exchange_strong(expected, index, std::memory_order_acq_rel) )
+		{
+			pass_gate();
+		}
+		release();
+	}
+
+public:
+	when_any_state(handles_type&& handles_, task_state<when_any_result<T>>* result_) :
+		handles(std::move(handles_)), inputs(handles.size()), result(result_),
+		winner(when_any_result<T>::npos), gate(handles.empty() ? 1 : 2), references(handles.size() + 1)
+	{}
+
+	static task_handle<when_any_result<T>> start(handles_type handles_)
+	{
+		pending_task_runner* const pool = handles_.empty() ? nullptr : handles_[0].native_pool();
+		task_state<when_any_result<T>>* const result = slab_new<task_state<when_any_result<T>>>();
+
+		when_any_state* const state = slab_new<when_any_state>(std::move(handles_), result);
+		std::size_t const count = state->handles.size();
+		for( std::size_t i = 0 ; i < count ; i++ )
+		{
+			state->inputs[i].owner = state;
+			state->inputs[i].index = i;
+			state->handles[i].native_state()->set_continuation(&state->inputs[i]);
+		}
+		state->pass_gate();
+		state->release();
+
+		return task_handle<when_any_result<T>>(result, pool);
+	}
+};
+
+template<typename T>
+task_handle<when_any_result<T>> when_any(std::vector<task_handle<T>> handles)
+{
+	return when_any_state<T>::start(std::move(handles));
+}
+
+#endif /* WHEN_ALL_CC */
@@ -0,0 +1,110 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * parallel_accumulate from ../3 on the work-stealing pool with metrics_level::timing, for a range of
+ * block sizes. For each one it prints the wall time and what stats() says about it :
+ *		tasks		tasks executed
+ *		steals		tasks taken from another worker's deque
+ *		sojourn		mean and p99 time between submit and start
+ *		run			mean time a task runs
+ *		busy		share of the workers' time spent running tasks rather than idle
+ * With tiny blocks the run time is dwarfed by the sojourn time and the per-task overhead. With a
+ * few huge blocks the workers sit idle at the end waiting for the last one. A good block size has
+ * tasks that run a good deal longer than they wait, while busy stays close to 100%.
+ * One more run with metrics_level::counters shows what the clock calls cost.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+template<typename Iterator, typename T>
+struct accumulate_block
+{
+	Iterator first, last;
+	T operator()()
+	{
+		return std::accumulate(first, last, T());
+	}
+};
+
+/* As ../3, one submit() per block */
+template<typename Iterator, typename T>
+T parallel_accumulate(thread_pool& pool, Iterator first, Iterator last, T init, unsigned long block_size)
+{
+	std::vector<task_handle<T>> handles;
+	for( Iterator block_start = first ; block_start != last ; )
+	{
+		Iterator block_end = block_start;
+		std::advance(block_end, std::min<unsigned long>(block_size, std::distance(block_start, last)));
+		handles.push_back(pool.submit(accumulate_block<Iterator, T>{block_start, block_end}));
+		block_start = block_end;
+	}
+
+	T result = init;
+	for( unsigned long i = 0 ; i < handles.size() ; i++ )
+	{
+		result += handles[i].get();
+	}
+	return result;
+}
+
+void measure(std::vector<long> const& data, unsigned long block_size, metrics_level level)
+{
+	long const expected = std::accumulate(data.begin(), data.end(), 0l);
+	thread_pool pool(std::max(std::thread::hardware_concurrency(), 1u), idle_options(), worker_placement::unpinned, level);
+
+	clock_type::time_point const start = clock_type::now();
+	long const result = parallel_accumulate(pool, data.begin(), data.end(), 0l, block_size);
+	clock_type::time_point const stop = clock_type::now();
+
+	/* The last task's run time is recorded just after its result is published, give it a moment */
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	worker_stats const total = pool.stats().total;
+	std::cout << std::setw(8) << block_size
+			  << std::setw(10) << std::chrono::duration<double, std::milli>(stop - start).count() << " ms"
+			  << std::setw(10) << total.tasks_executed
+			  << std::setw(8) << total.steals;
+	if( level == metrics_level::timing )
+	{
+		double const busy = total.busy_ns + total.idle_ns ?
+				100.0 * total.busy_ns / (total.busy_ns + total.idle_ns) : 0.0;
+		std::cout << std::setw(12) << total.sojourn_ns.mean() / 1000 << " us"
+				  << std::setw(12) << total.sojourn_ns.percentile(0.99) / 1000.0 << " us"
+				  << std::setw(12) << total.run_ns.mean() / 1000 << " us"
+				  << std::setw(8) << busy << " %";
+	}
+	else
+	{
+		std::cout << "  (counters only)";
+	}
+	std::cout << (result == expected ? "" : "  WRONG RESULT") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const length = argc > 1 ? std::atol(argv[1]) : 10000000;
+	std::vector<long> data(length);
+	std::iota(data.begin(), data.end(), 0);
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "   block        time     tasks  steals  sojourn mean  sojourn p99    run mean    busy" << std::endl;
+	unsigned long const block_sizes[] = { 25, 250, 2500, 25000, 250000, 2500000 };
+	for( unsigned i = 0 ; i < sizeof(block_sizes) / sizeof(block_sizes[0]) ; i++ )
+	{
+		measure(data, block_sizes[i], metrics_level::timing);
+	}
+	measure(data, 25, metrics_level::counters);
+	return 0;
+}
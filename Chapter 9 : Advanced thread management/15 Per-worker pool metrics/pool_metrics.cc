@@ -0,0 +1,231 @@
+/*
+ * pool_metrics.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The block_size of 25 in ../3 was picked blind : nothing in the pools says how long tasks wait in
+the queues, how long they run, or how much of the time the workers sit idle. This file has the
+counters the work-stealing pool in ../6 keeps per worker. thread_pool::stats() merges them into a
+pool_stats snapshot.
+
+1. Each worker has its own worker_metrics slot, aligned to a cache line so workers never write
+   to the same line. Only the owning worker writes its slot, so an update is a relaxed load and
+   store, not a locked read-modify-write. Threads outside the pool that run tasks through
+   run_pending_task() share one extra slot, which uses fetch_add.
+2. Counters, always on : tasks executed, pops from the worker's own deque, pops from the global
+   queue, steals, pops from the worker's inbox of affine tasks (../21), and log2 histograms of the
+   own-deque and global-queue depth sampled every 64 tasks.
+3. Timing, with metrics_level::timing only, since each reading costs a clock call : sojourn time
+   (enqueue to start) and run time histograms in nanoseconds, and busy versus idle time per
+   worker.
+Reading while the workers run gives a snapshot that is consistent per counter, not across them.
+ */
+#ifndef POOL_METRICS_CC
+#define POOL_METRICS_CC
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+enum class metrics_level
+{
+	counters,		// task, pop and steal counts and queue depth samples
+	timing			// also sojourn and run time histograms, busy and idle time
+};
+
+inline std::uint64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Add to a counter. Single writer : load and store. Shared : fetch_add */
+inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t n, bool shared)
+{
+	if( shared )
+	{
+		counter.fetch_add(n, std::memory_order_relaxed);
+	}
+	else
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+}
+
+/* Plain copy of a log2_histogram. Bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i) */
+struct histogram_snapshot
+{
+	static unsigned const bucket_count = 40;
+
+	std::uint64_t buckets[bucket_count];
+	std::uint64_t count;
+	std::uint64_t sum;
+
+	histogram_snapshot() : count(0), sum(0)
+	{
+		for( unsigned i = 0 ; i < bucket_count ; i++ )
+		{
+			buckets[i] = 0;
+		}
+	}
+
+	void merge(histogram_snapshot const& other)
+	{
+		for( unsigned i = 0 ; i < bucket_count ; i++ )
+		{
+			buckets[i] += other.buckets[i];
+		}
+		count += other.count;
+		sum += other.sum;
+	}
+
+	double mean() const
+	{
+		return count ? static_cast<double>(sum) / count : 0.0;
+	}
+
+	/* Upper bound of the bucket holding the p-th fraction of the values, p in [0, 1] */
+	std::uint64_t percentile(double p) const
+	{
+		std::uint64_t const rank = static_cast<std::uint64_t>(p * count);
+		std::uint64_t seen = 0;
+		for( unsigned i = 0 ; i < bucket_count ; i++ )
+		{
+			seen += buckets[i];
+			if( seen > rank || seen == count )
+			{
+				return i == 0 ? 0 : (std::uint64_t(1) << i) - 1;
+			}
+		}
+		return 0;
+	}
+};
+
+class log2_histogram
+{
+	std::atomic<std::uint64_t> buckets[histogram_snapshot::bucket_count];
+	std::atomic<std::uint64_t> sum;
+
+public:
+	log2_histogram() : sum(0)
+	{
+		for( unsigned i = 0 ; i < histogram_snapshot::bucket_count ; i++ )
+		{
+			buckets[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void record(std::uint64_t value, bool shared)
+	{
+		unsigned const bucket = std::min<unsigned>(std::bit_width(value), histogram_snapshot::bucket_count - 1);
+		bump(buckets[bucket], 1, shared);
+		bump(sum, value, shared);
+	}
+
+	histogram_snapshot snapshot() const
+	{
+		histogram_snapshot s;
+		for( unsigned i = 0 ; i < histogram_snapshot::bucket_count ; i++ )
+		{
+			s.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+			s.count += s.buckets[i];
+		}
+		s.sum = sum.load(std::memory_order_relaxed);
+		return s;
+	}
+};
+
+/* Plain copy of a worker_metrics slot, or the sum of several */
+struct worker_stats
+{
+	std::uint64_t tasks_executed;
+	std::uint64_t local_pops;
+	std::uint64_t pool_pops;
+	std::uint64_t steals;
+	std::uint64_t inbox_pops;
+	std::uint64_t busy_ns;
+	std::uint64_t idle_ns;
+	histogram_snapshot local_depth;
+	histogram_snapshot pool_depth;
+	histogram_snapshot sojourn_ns;
+	histogram_snapshot run_ns;
+
+	worker_stats() : tasks_executed(0), local_pops(0), pool_pops(0), steals(0), inbox_pops(0), busy_ns(0), idle_ns(0)
+	{}
+
+	void merge(worker_stats const& other)
+	{
+		tasks_executed += other.tasks_executed;
+		local_pops += other.local_pops;
+		pool_pops += other.pool_pops;
+		steals += other.steals;
+		inbox_pops += other.inbox_pops;
+		busy_ns += other.busy_ns;
+		idle_ns += other.idle_ns;
+		local_depth.merge(other.local_depth);
+		pool_depth.merge(other.pool_depth);
+		sojourn_ns.merge(other.sojourn_ns);
+		run_ns.merge(other.run_ns);
+	}
+};
+
+struct alignas(64) worker_metrics
+{
+	bool shared;			// written by more than one thread (the slot for non pool threads)
+	std::atomic<std::uint64_t> tasks_executed;
+	std::atomic<std::uint64_t> local_pops;
+	std::atomic<std::uint64_t> pool_pops;
+	std::atomic<std::uint64_t> steals;
+	std::atomic<std::uint64_t> inbox_pops;
+	std::atomic<std::uint64_t> busy_ns;
+	std::atomic<std::uint64_t> idle_ns;
+	log2_histogram local_depth;
+	log2_histogram pool_depth;
+	log2_histogram sojourn_ns;
+	log2_histogram run_ns;
+
+	worker_metrics() : shared(false), tasks_executed(0), local_pops(0), pool_pops(0), steals(0),
+		inbox_pops(0), busy_ns(0), idle_ns(0)
+	{}
+
+	void add(std::atomic<std::uint64_t>& counter, std::uint64_t n = 1)
+	{
+		bump(counter, n, shared);
+	}
+
+	void record(log2_histogram& histogram, std::uint64_t value)
+	{
+		histogram.record(value, shared);
+	}
+
+	worker_stats snapshot() const
+	{
+		worker_stats s;
+		s.tasks_executed = tasks_executed.load(std::memory_order_relaxed);
+		s.local_pops = local_pops.load(std::memory_order_relaxed);
+		s.pool_pops = pool_pops.load(std::memory_order_relaxed);
+		s.steals = steals.load(std::memory_order_relaxed);
+		s.inbox_pops = inbox_pops.load(std::memory_order_relaxed);
+		s.busy_ns = busy_ns.load(std::memory_order_relaxed);
+		s.idle_ns = idle_ns.load(std::memory_order_relaxed);
+		s.local_depth = local_depth.snapshot();
+		s.pool_depth = pool_depth.snapshot();
+		s.sojourn_ns = sojourn_ns.snapshot();
+		s.run_ns = run_ns.snapshot();
+		return s;
+	}
+};
+
+/* What thread_pool::stats() returns */
+struct pool_stats
+{
+	std::vector<worker_stats> workers;		// one per pool thread
+	worker_stats external;					// tasks run by threads outside the pool
+	worker_stats total;						// everything merged
+};
+
+#endif /* POOL_METRICS_CC */
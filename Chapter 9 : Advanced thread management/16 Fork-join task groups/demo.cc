@@ -0,0 +1,113 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * 1. An in-place quicksort with a task_group per level : run() the lower part, recurse on the upper
+ *    part, wait(). Nothing is allocated per child and waiting workers keep running other tasks.
+ * 2. A parallel search : every block is a child of one group, and the child that finds the value
+ *    cancels the group so the blocks that have not started are skipped.
+ * 3. A child that throws : the exception comes out of wait().
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "task_group.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+void parallel_quick_sort(thread_pool& pool, int* first, int* last)
+{
+	if( last - first <= 2048 )
+	{
+		std::sort(first, last);
+		return;
+	}
+
+	int const pivot = first[(last - first) / 2];
+	int* const middle1 = std::partition(first, last, [pivot](int x) { return x < pivot; });
+	int* const middle2 = std::partition(middle1, last, [pivot](int x) { return !(pivot < x); });
+
+	task_group g(pool);
+	g.run([&pool, first, middle1] { parallel_quick_sort(pool, first, middle1); });
+	parallel_quick_sort(pool, middle2, last);
+	g.wait();
+}
+
+int main(int argc, char **argv)
+{
+	std::size_t const length = argc > 1 ? std::atol(argv[1]) : 1000000;
+	thread_pool pool;
+
+	std::vector<int> data(length);
+	for( std::size_t i = 0 ; i < length ; i++ )
+	{
+		data[i] = std::rand();
+	}
+	clock_type::time_point const start = clock_type::now();
+	parallel_quick_sort(pool, data.data(), data.data() + data.size());
+	clock_type::time_point const stop = clock_type::now();
+	std::cout << "sorted " << length << " elements in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms"
+			  << (std::is_sorted(data.begin(), data.end()) ? ", ok" : ", NOT SORTED") << std::endl;
+
+	/* Look for a value near the front, the blocks behind it are cancelled before they start */
+	std::vector<int> haystack(length);
+	for( std::size_t i = 0 ; i < length ; i++ )
+	{
+		haystack[i] = static_cast<int>(i);
+	}
+	int const needle = static_cast<int>(length / 100);
+	std::size_t const block_size = 1000;
+	std::atomic<std::size_t> blocks_searched(0);
+	std::atomic<long> found_at(-1);
+
+	task_group search(pool);
+	for( std::size_t begin = 0 ; begin < length ; begin += block_size )
+	{
+		search.run([&, begin]
+		{
+			blocks_searched++;
+			std::size_t const end = std::min(begin + block_size, length);
+			for( std::size_t i = begin ; i < end && !search.is_cancelling() ; i++ )
+			{
+				if( haystack[i] == needle )
+				{
+					found_at = static_cast<long>(i);
+					search.cancel();
+				}
+			}
+		});
+	}
+	search.wait();
+	std::cout << "found " << needle << " at " << found_at << " after searching " << blocks_searched << " of "
+			  << (length + block_size - 1) / block_size << " blocks" << std::endl;
+
+	task_group failing(pool);
+	for( unsigned i = 0 ; i < 8 ; i++ )
+	{
+		failing.run([i]
+		{
+			if( i == 3 )
+			{
+				throw std::runtime_error("child 3 failed");
+			}
+		});
+	}
+	try
+	{
+		failing.wait();
+	}
+	catch(std::exception const& e)
+	{
+		std::cout << "wait() rethrew : " << e.what() << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * task_group.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The quicksort in ../4 spawns its lower half with submit(), recurses on the upper half and then
+polls the future, running other tasks until it is ready. Every child costs a packaged_task and a
+future, and the spawn / recurse / poll loop is written out by hand in each algorithm.
+
+A task_group collects children on the work-stealing pool in ../6 :
+1. run(f) posts f to the pool and counts it. There is no per-child shared state : the child is
+   the group pointer plus f, stored inline in the function_wrapper and a slab-allocated deque node.
+2. wait() returns once every child has finished. On a pool thread it runs pending tasks meanwhile,
+   like task_handle::wait(). Only if there is nothing left to run does it sleep, on a condition
+   variable that children only touch when somebody is actually waiting. While somebody is, children
+   count themselves done under its mutex, so none of them can still be inside the group once the
+   waiter sees the count reach zero.
+3. cancel() marks the group. Children that have not started yet are skipped, running ones can
+   check is_cancelling(). A group made with a parent is also cancelled when the parent is, so
+   nested fork-join code can be stopped from the top.
+4. The first exception thrown by a child cancels the group and is rethrown by wait().
+After wait() returns or throws, the group can be used again.
+The destructor cancels and waits if there are still children, since they refer to the group.
+ */
+#ifndef TASK_GROUP_CC
+#define TASK_GROUP_CC
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+class task_group
+{
+	/* The top bit of pending says somebody is asleep in wait() */
+	static std::uint64_t const waiter_bit = std::uint64_t(1) << 63;
+
+	thread_pool& pool;
+	task_group const* const parent;
+	std::atomic<std::uint64_t> pending;			// children not finished yet, plus waiter_bit
+	std::atomic<bool> cancelled;
+	std::atomic<bool> failed;
+	std::exception_ptr error;					// written once, by whoever sets failed
+	std::mutex wait_mutex;
+	std::condition_variable all_done;
+
+	/* What goes in the queue. If the pool drops it unrun it still counts as finished */
+	template<typename F>
+	class child
+	{
+		task_group* group;
+		F f;
+
+	public:
+		child(task_group* group_, F&& f_) : group(group_), f(std::move(f_))
+		{}
+
+		child(child&& other) noexcept(std::is_nothrow_move_constructible<F>::value) :
+			group(other.group), f(std::move(other.f))
+		{
+			other.group = nullptr;
+		}
+
+		child(const child&) = delete;
+		child& operator = (const child&) = delete;
+
+		~child()
+		{
+			if( group )
+			{
+				group->child_done();
+			}
+		}
+
+		void operator () ()
+		{
+			task_group* const g = group;
+			group = nullptr;
+			if( !g->is_cancelling() )
+			{
+				try
+				{
+					f();
+				}
+				catch(...)
+				{
+					g->child_failed(std::current_exception());
+				}
+			}
+			g->child_done();
+		}
+	};
+
+	void child_failed(std::exception_ptr e)
+	{
+		if( !failed.exchange(true) )
+		{
+			error = e;
+		}
+		cancel();
+	}
+
+	/*
+	 * Without a waiter the count goes down with a compare-exchange and no lock. Once waiter_bit is set
+	 * it goes down under wait_mutex, so the waiter cannot see zero, return and destroy the group
+	 * before the last child has finished notifying : the child's unlock is its last touch of *this.
+	 */
+	void child_done()
+	{
+		std::uint64_t before = pending.load(std::memory_order_relaxed);
+		while( !(before & waiter_bit) )
+		{
+			if( pending.compare_exchange_weak(before, before - 1, std::memory_order_acq_rel, std::memory_order_relaxed) )
+			{
+				return;
+			}
+		}
+
+		std::lock_guard<std::mutex> lk(wait_mutex);
+		if( pending.fetch_sub(1, std::memory_order_acq_rel) == (waiter_bit | 1) )
+		{
+			all_done.notify_all();
+		}
+	}
+
+	std::uint64_t children() const
+	{
+		return pending.load(std::memory_order_acquire) & ~waiter_bit;
+	}
+
+	/* waiter_bit is only set and cleared with wait_mutex held */
+	void sleep_until_done()
+	{
+		std::unique_lock<std::mutex> lk(wait_mutex);
+		if( (pending.fetch_or(waiter_bit, std::memory_order_acq_rel) & ~waiter_bit) != 0 )
+		{
+			all_done.wait(lk, [this] { return children() == 0; });
+		}
+		pending.fetch_and(~waiter_bit, std::memory_order_relaxed);
+	}
+
+	void wait_quietly()
+	{
+		if( pool.is_pool_thread() )
+		{
+			idle_backoff backoff((idle_options()));
+			while( children() != 0 )
+			{
+				if( pool.run_pending_task() )
+				{
+					backoff.reset();
+				}
+				else if( !backoff.backoff() )
+				{
+					break;
+				}
+			}
+		}
+		if( children() != 0 )
+		{
+			sleep_until_done();
+		}
+	}
+
+public:
+	explicit task_group(thread_pool& pool_, task_group const* parent_ = nullptr) :
+		pool(pool_), parent(parent_), pending(0), cancelled(false), failed(false)
+	{}
+
+	task_group(const task_group&) = delete;
+	task_group& operator = (const task_group&) = delete;
+
+	~task_group()
+	{
+		if( children() != 0 )
+		{
+			cancel();
+			wait_quietly();
+		}
+	}
+
+	template<typename FunctionType>
+	void run(FunctionType f)
+	{
+		pending.fetch_add(1, std::memory_order_relaxed);
+		pool.post(child<FunctionType>(this, std::move(f)));
+	}
+
+	/* Children that have not started yet are skipped */
+	void cancel()
+	{
+		cancelled.store(true, std::memory_order_relaxed);
+	}
+
+	bool is_cancelling() const
+	{
+		return cancelled.load(std::memory_order_relaxed) || (parent && parent->is_cancelling());
+	}
+
+	/* Help until every child has finished, then rethrow the first exception if any */
+	void wait()
+	{
+		wait_quietly();
+
+		cancelled.store(false, std::memory_order_relaxed);
+		if( failed.exchange(false) )
+		{
+			std::exception_ptr const e = error;
+			error = nullptr;
+			std::rethrow_exception(e);
+		}
+	}
+};
+
+#endif /* TASK_GROUP_CC */
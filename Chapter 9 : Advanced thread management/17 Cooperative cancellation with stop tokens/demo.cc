@@ -0,0 +1,127 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * parallel_find on the work-stealing pool : one task per block, the match sits 10% of the way in.
+ * Three ways of stopping once it is found :
+ * 1. none : every block is searched to the end, which is what draining the queue amounts to.
+ * 2. a std::atomic<bool> done flag checked on every element, as in Chapter 8 listings 7 and 8.
+ *    Every queued block is still popped and started, and the per-element check keeps the
+ *    compiler from vectorising the loop.
+ * 3. a std::stop_token : blocks still queued when stop is requested are dropped before they run,
+ *    and running ones poll through a stop_poller every 1024 elements.
+ * For each it prints the time and how many blocks actually started.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+enum class early_exit { none, done_flag, stop_token };
+
+template<typename Iterator, typename MatchType>
+Iterator parallel_find(thread_pool& pool, Iterator first, Iterator last, MatchType match, early_exit how,
+					   std::atomic<unsigned long>& blocks_started)
+{
+	unsigned long const block_size = 1 << 16;
+	std::atomic<bool> done(false);
+	std::stop_source source;
+
+	std::vector<task_handle<Iterator>> handles;
+	for( Iterator block_start = first ; block_start != last ; )
+	{
+		Iterator block_end = block_start;
+		std::advance(block_end, std::min<unsigned long>(block_size, std::distance(block_start, last)));
+
+		if( how == early_exit::stop_token )
+		{
+			handles.push_back(pool.submit([block_start, block_end, last, match, &source, &blocks_started]
+			{
+				blocks_started++;
+				stop_poller poller(source.get_token());
+				for( Iterator it = block_start ; it != block_end && !poller.stop_requested() ; ++it )
+				{
+					if( *it == match )
+					{
+						source.request_stop();
+						return it;
+					}
+				}
+				return last;
+			}, source.get_token()));
+		}
+		else
+		{
+			handles.push_back(pool.submit([block_start, block_end, last, match, how, &done, &blocks_started]
+			{
+				blocks_started++;
+				Iterator found = last;
+				for( Iterator it = block_start ; it != block_end ; ++it )
+				{
+					if( how == early_exit::done_flag && done.load() )
+					{
+						break;
+					}
+					if( *it == match && found == last )
+					{
+						found = it;
+						done = true;
+					}
+				}
+				return found;
+			}));
+		}
+		block_start = block_end;
+	}
+
+	/* Every handle has to be waited for, the tasks refer to our locals */
+	Iterator result = last;
+	for( unsigned long i = 0 ; i < handles.size() ; i++ )
+	{
+		try
+		{
+			Iterator const found = handles[i].get();
+			if( found != last && result == last )
+			{
+				result = found;
+			}
+		}
+		catch(task_cancelled const&)
+		{}
+	}
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	std::size_t const length = argc > 1 ? std::atol(argv[1]) : 50000000;
+	std::vector<int> data(length, 0);
+	std::size_t const position = length / 10;
+	data[position] = 1;
+
+	thread_pool pool;
+	char const* const names[] = { "no early exit      ", "done flag (Ch8)    ", "stop_token + poller" };
+	early_exit const ways[] = { early_exit::none, early_exit::done_flag, early_exit::stop_token };
+	for( unsigned i = 0 ; i < 3 ; i++ )
+	{
+		std::atomic<unsigned long> blocks_started(0);
+		clock_type::time_point const start = clock_type::now();
+		std::vector<int>::const_iterator const found = parallel_find(pool, data.cbegin(), data.cend(), 1, ways[i], blocks_started);
+		clock_type::time_point const stop = clock_type::now();
+
+		std::cout << names[i] << " : " << std::chrono::duration<double, std::milli>(stop - start).count() << " ms, "
+				  << blocks_started << " blocks started"
+				  << (found != data.cend() && std::size_t(found - data.cbegin()) == position ? "" : ", WRONG RESULT")
+				  << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * stoppable_task.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+parallel_find in Chapter 8 (listings 7 and 8) hands every worker a raw std::atomic<bool>* done flag
+and checks it on every element. On a pool the blocks would be queued tasks, and a task queued
+behind the match still gets popped and runs its loop until its first check.
+
+C++20 already has the facility : std::stop_source hands out std::stop_token, and request_stop()
+flips all of them at once. This file ties them to the work-stealing pool in ../6 :
+1. thread_pool::submit(f, token) and post(f, token) check the token when the task is popped. If stop
+   has been requested, f never runs and the handle gets a task_cancelled exception.
+2. stop_poller is for the loops inside a task. stop_requested() only reads the token every
+   poll_interval calls, and the other calls are a decrement and a compare.
+ */
+#ifndef STOPPABLE_TASK_CC
+#define STOPPABLE_TASK_CC
+
+#include <exception>
+#include <stop_token>
+#include <utility>
+#include "../10 Pool-native task handles/task_handle.cc"
+
+/* What get() throws for a task that was dropped because stop was requested */
+class task_cancelled : public std::exception
+{
+public:
+	char const* what() const noexcept override
+	{
+		return "task cancelled before it started";
+	}
+};
+
+/* Made once, so dropping a task does not cost a throw */
+inline std::exception_ptr task_cancelled_error()
+{
+	static std::exception_ptr const error = std::make_exception_ptr(task_cancelled());
+	return error;
+}
+
+/* A task_body<> that is only run if stop has not been requested by the time it is popped */
+template<typename F, typename T>
+class stoppable_task_body
+{
+	task_body<F, T> body;
+	std::stop_token token;
+
+public:
+	stoppable_task_body(F&& f_, task_state<T>* state_, std::stop_token token_) :
+		body(std::move(f_), state_), token(std::move(token_))
+	{}
+
+	void operator () ()
+	{
+		if( token.stop_requested() )
+		{
+			body.fail(task_cancelled_error());
+		}
+		else
+		{
+			body();
+		}
+	}
+};
+
+/* The same for post(), which has no state to report to */
+template<typename F>
+class stoppable_task
+{
+	F f;
+	std::stop_token token;
+
+public:
+	stoppable_task(F&& f_, std::stop_token token_) : f(std::move(f_)), token(std::move(token_))
+	{}
+
+	void operator () ()
+	{
+		if( !token.stop_requested() )
+		{
+			f();
+		}
+	}
+};
+
+/*
+ * Amortized polling for long loops :
+ *		stop_poller poller(token);
+ *		for( ; begin != end && !poller.stop_requested() ; ++begin )
+ */
+class stop_poller
+{
+	std::stop_token token;
+	unsigned const poll_interval;
+	unsigned countdown;
+	bool stopped;
+
+public:
+	explicit stop_poller(std::stop_token token_, unsigned poll_interval_ = 1024) :
+		token(std::move(token_)), poll_interval(poll_interval_ ? poll_interval_ : 1), countdown(1), stopped(false)
+	{}
+
+	bool stop_requested()
+	{
+		if( --countdown == 0 )
+		{
+			countdown = poll_interval;
+			stopped = token.stop_requested();
+		}
+		return stopped;
+	}
+};
+
+#endif /* STOPPABLE_TASK_CC */
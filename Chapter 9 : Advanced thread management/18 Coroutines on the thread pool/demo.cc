@@ -0,0 +1,209 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * 1. 20000 "requests" on a pool with hardware_concurrency() workers. Each one moves onto the pool
+ *    with co_await pool.schedule(), waits 10 ms on a timer and then does a little work submitted to
+ *    the pool, co_awaiting its handle. While waiting a request holds no thread, so all of them are
+ *    in flight at once. For comparison the same requests written as blocking tasks that sleep
+ *    for 10 ms, where only one request per worker is in flight.
+ * 2. A chain of task<long> coroutines a million deep, each co_awaiting the next. With symmetric
+ *    transfer this runs in constant stack space, but only when built with -O2 (see pool_coroutines.cc).
+ * 3. An exception thrown in a nested task comes out of co_await.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+/* Stands in for an I/O reactor : one thread completing task states when their deadline passes */
+class timer_service
+{
+	typedef std::pair<clock_type::time_point, task_state<void>*> entry;
+
+	pending_task_runner* const pool;
+	std::mutex m;
+	std::condition_variable wake;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> deadlines;
+	bool done;
+	std::thread worker;
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lk(m);
+		while( !done || !deadlines.empty() )
+		{
+			if( deadlines.empty() )
+			{
+				wake.wait(lk);
+			}
+			else if( deadlines.top().first > clock_type::now() )
+			{
+				wake.wait_until(lk, deadlines.top().first);
+			}
+			else
+			{
+				task_state<void>* const state = deadlines.top().second;
+				deadlines.pop();
+				lk.unlock();
+				state->set_value();
+				state->release();
+				lk.lock();
+			}
+		}
+	}
+
+public:
+	explicit timer_service(pending_task_runner* pool_) : pool(pool_), done(false), worker(&timer_service::run, this)
+	{}
+
+	~timer_service()
+	{
+		{
+			std::lock_guard<std::mutex> lk(m);
+			done = true;
+		}
+		wake.notify_one();
+		worker.join();
+	}
+
+	/* Ready after delay, whoever co_awaits it is resumed on the pool */
+	task_handle<void> after(std::chrono::milliseconds delay)
+	{
+		task_state<void>* const state = slab_new<task_state<void>>();
+		{
+			std::lock_guard<std::mutex> lk(m);
+			deadlines.push(entry(clock_type::now() + delay, state));
+		}
+		wake.notify_one();
+		return task_handle<void>(state, pool);
+	}
+};
+
+void note_in_flight(std::atomic<long>& in_flight, std::atomic<long>& peak)
+{
+	long const now = ++in_flight;
+	long seen = peak.load();
+	while( now > seen && !peak.compare_exchange_weak(seen, now) )
+	{}
+}
+
+task<long> request(thread_pool& pool, timer_service& timer, long id, std::atomic<long>& in_flight, std::atomic<long>& peak)
+{
+	co_await pool.schedule();
+	note_in_flight(in_flight, peak);
+	co_await timer.after(std::chrono::milliseconds(10));
+	in_flight--;
+	long const reply = co_await pool.submit([id] { return id * 2; });
+	co_return reply;
+}
+
+task<long> depth(long n)
+{
+	if( n == 0 )
+	{
+		co_return 0;
+	}
+	co_return 1 + co_await depth(n - 1);
+}
+
+task<int> fails()
+{
+	throw std::runtime_error("thrown three tasks down");
+	co_return 0;
+}
+
+task<int> middle()
+{
+	co_return co_await fails();
+}
+
+task<void> top(std::string& message)
+{
+	try
+	{
+		co_await middle();
+	}
+	catch(std::exception const& e)
+	{
+		message = e.what();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	long const requests = argc > 1 ? std::atol(argv[1]) : 20000;
+	thread_pool pool;
+	timer_service timer(&pool);
+	unsigned const workers = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	std::atomic<long> in_flight(0);
+	std::atomic<long> peak(0);
+	clock_type::time_point start = clock_type::now();
+	std::vector<task_handle<long>> handles;
+	handles.reserve(requests);
+	for( long i = 0 ; i < requests ; i++ )
+	{
+		handles.push_back(::start(request(pool, timer, i, in_flight, peak), &pool));
+	}
+	long sum = 0;
+	for( unsigned long i = 0 ; i < handles.size() ; i++ )
+	{
+		sum += handles[i].get();
+	}
+	clock_type::time_point stop = clock_type::now();
+	std::cout << "coroutines : " << requests << " requests on " << workers << " workers in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms, "
+			  << peak << " in flight at once" << (sum == requests * (requests - 1) ? "" : ", WRONG SUM") << std::endl;
+
+	/* The blocking version takes requests / workers * 10 ms, so only run a few of them */
+	long const blocking_requests = std::min<long>(requests, 50 * workers);
+	in_flight = 0;
+	peak = 0;
+	start = clock_type::now();
+	std::vector<task_handle<long>> blocking;
+	for( long i = 0 ; i < blocking_requests ; i++ )
+	{
+		blocking.push_back(pool.submit([i, &in_flight, &peak]
+		{
+			note_in_flight(in_flight, peak);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			in_flight--;
+			return i * 2;
+		}));
+	}
+	for( unsigned long i = 0 ; i < blocking.size() ; i++ )
+	{
+		blocking[i].get();
+	}
+	stop = clock_type::now();
+	std::cout << "blocking   : " << blocking_requests << " requests on " << workers << " workers in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms, "
+			  << peak << " in flight at once" << std::endl;
+
+	long const chain = 1000000;
+	std::cout << "co_await chain " << chain << " deep : " << ::start(depth(chain)).get() << std::endl;
+
+	std::string message;
+	::start(top(message)).get();
+	std::cout << "co_await rethrew : " << message << std::endl;
+	return 0;
+}
@@ -0,0 +1,462 @@
+/*
+ * pool_coroutines.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+Waiting on a task_handle<> (or a std::future<>) ties up the waiting thread. On a pool thread it at
+least helps, but a request handler that waits on I/O still holds a whole worker, so the number of
+requests in flight is limited to the number of threads.
+
+With C++20 coroutines a handler suspends instead : its frame stays on the heap and the worker
+goes off to run something else.
+1. co_await pool.schedule() suspends and queues the resumption on the pool, so the rest of the
+   coroutine runs on a worker.
+2. co_await handle, for a task_handle<T>, attaches the resumption to the task's state as a
+   continuation (../14) and returns its value or rethrows. When the task finishes, the resumption
+   is queued on the handle's pool. Nothing blocks.
+   Both awaitables derive from scheduled_continuation and live in the coroutine frame, so
+   suspending allocates nothing.
+3. task<T> is a lazily started coroutine. co_await on a task<T> starts it, and it resumes the
+   awaiting coroutine when it finishes. Both hand-offs use symmetric transfer (await_suspend
+   returns the next coroutine_handle), so a chain of co_awaits a million deep does not grow the
+   stack. GCC only turns the transfer into a tail call with -foptimize-sibling-calls, which -O2
+   enables; at -O0 or -O1 a deep chain still recurses. Frames come from the slab allocator (../10).
+4. start(task) runs a task<T> until its first suspension and returns a task_handle<T> for it, so
+   ordinary code can get() it, or when_all() a batch of them.
+If the pool is destroyed while a coroutine is queued for resumption, the chain of task<T>s it
+belongs to is destroyed from the coroutine start() made for it, frames and all, and the handle
+start() returned gets std::future_error(broken_promise). Other kinds of coroutine are left
+suspended, for whoever owns their frame to destroy.
+ */
+#ifndef POOL_COROUTINES_CC
+#define POOL_COROUTINES_CC
+
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "../10 Pool-native task handles/task_handle.cc"
+
+/*
+ * Base of the promises of task<T> and of the coroutine start() runs : who is awaiting this coroutine,
+ * so that an abandoned resumption can find the coroutine at the root of the chain, which owns the
+ * frames of all the others.
+ */
+class coroutine_link
+{
+public:
+	coroutine_link* parent;							// nullptr at the root, or when awaited by another kind of coroutine
+	void (*abandon_chain)(coroutine_link* root);	// only set at a root made by start()
+
+	coroutine_link() : parent(nullptr), abandon_chain(nullptr)
+	{}
+
+	/* Destroy the whole chain link belongs to, if start() made its root. Otherwise leave it suspended */
+	static void abandon(coroutine_link* link)
+	{
+		if( !link )
+		{
+			return;
+		}
+		while( link->parent )
+		{
+			link = link->parent;
+		}
+		if( link->abandon_chain )
+		{
+			link->abandon_chain(link);
+		}
+	}
+};
+
+template<typename Promise>
+coroutine_link* link_of(std::coroutine_handle<Promise> h)
+{
+	if constexpr( std::is_base_of<coroutine_link, Promise>::value )
+	{
+		return &h.promise();
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+
+/* What pool.schedule() returns */
+class schedule_awaitable : public scheduled_continuation
+{
+	std::coroutine_handle<> coroutine;
+	coroutine_link* link;
+
+public:
+	explicit schedule_awaitable(pending_task_runner* pool_) : scheduled_continuation(pool_), link(nullptr)
+	{}
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	/* May resume on a worker before this returns, so nothing touches *this after fire() */
+	template<typename Promise>
+	void await_suspend(std::coroutine_handle<Promise> h)
+	{
+		coroutine = h;
+		link = link_of(h);
+		fire();
+	}
+
+	void await_resume() const noexcept
+	{}
+
+	void run() override
+	{
+		coroutine.resume();
+	}
+
+	/* Destroys the frame we live in, so it must be the last thing we do */
+	void abandon() override
+	{
+		coroutine_link::abandon(link);
+	}
+};
+
+/* co_await on a task_handle<T> : resume on the handle's pool once the task is done */
+template<typename T>
+class task_handle_awaiter : public scheduled_continuation
+{
+	task_handle<T> handle;
+	std::coroutine_handle<> coroutine;
+	coroutine_link* link;
+
+public:
+	explicit task_handle_awaiter(task_handle<T>&& handle_) :
+		scheduled_continuation(handle_.native_pool()), handle(std::move(handle_)), link(nullptr)
+	{}
+
+	bool await_ready() const
+	{
+		return handle.is_ready();
+	}
+
+	template<typename Promise>
+	void await_suspend(std::coroutine_handle<Promise> h)
+	{
+		coroutine = h;
+		link = link_of(h);
+		handle.native_state()->set_continuation(this);
+	}
+
+	/* Ready by now, so get() does not wait */
+	T await_resume()
+	{
+		return handle.get();
+	}
+
+	void run() override
+	{
+		coroutine.resume();
+	}
+
+	/* Destroys the frame we live in, so it must be the last thing we do */
+	void abandon() override
+	{
+		coroutine_link::abandon(link);
+	}
+};
+
+template<typename T>
+task_handle_awaiter<T> operator co_await(task_handle<T>&& handle)
+{
+	return task_handle_awaiter<T>(std::move(handle));
+}
+
+/* Like get(), co_await consumes the handle */
+template<typename T>
+task_handle_awaiter<T> operator co_await(task_handle<T>& handle)
+{
+	return task_handle_awaiter<T>(std::move(handle));
+}
+
+template<typename T>
+class task;
+
+/* Everything in a task's promise that does not depend on T */
+class task_promise_base : public coroutine_link
+{
+	/* At the end of the task, transfer straight to whoever awaited it */
+	struct final_awaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept
+		{
+			std::coroutine_handle<> const next = finished.promise().continuation;
+			return next ? next : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept
+		{}
+	};
+
+public:
+	std::coroutine_handle<> continuation;
+	std::exception_ptr error;
+
+	/* Frames are small and short-lived, just like task states */
+	static void* operator new(std::size_t size)
+	{
+		return slab_allocator::allocate(size);
+	}
+
+	static void operator delete(void* p)
+	{
+		slab_allocator::deallocate(p);
+	}
+
+	std::suspend_always initial_suspend() const noexcept
+	{
+		return std::suspend_always();
+	}
+
+	final_awaiter final_suspend() const noexcept
+	{
+		return final_awaiter();
+	}
+
+	void unhandled_exception()
+	{
+		error = std::current_exception();
+	}
+};
+
+template<typename T>
+class task_promise : public task_promise_base
+{
+public:
+	std::optional<T> value;
+
+	task<T> get_return_object();
+
+	template<typename U>
+	void return_value(U&& v)
+	{
+		value.emplace(std::forward<U>(v));
+	}
+
+	T result()
+	{
+		if( error )
+		{
+			std::rethrow_exception(error);
+		}
+		return std::move(*value);
+	}
+};
+
+template<>
+class task_promise<void> : public task_promise_base
+{
+public:
+	task<void> get_return_object();
+
+	void return_void()
+	{}
+
+	void result()
+	{
+		if( error )
+		{
+			std::rethrow_exception(error);
+		}
+	}
+};
+
+template<typename T>
+class task
+{
+public:
+	typedef task_promise<T> promise_type;
+
+private:
+	std::coroutine_handle<promise_type> coroutine;
+
+	struct awaiter
+	{
+		std::coroutine_handle<promise_type> coroutine;
+
+		bool await_ready() const noexcept
+		{
+			return !coroutine || coroutine.done();
+		}
+
+		/* Start the task by transferring to it, it transfers back to us when it finishes */
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept
+		{
+			coroutine.promise().continuation = awaiting;
+			coroutine.promise().parent = link_of(awaiting);
+			return coroutine;
+		}
+
+		T await_resume()
+		{
+			return coroutine.promise().result();
+		}
+	};
+
+public:
+	explicit task(std::coroutine_handle<promise_type> coroutine_) : coroutine(coroutine_)
+	{}
+
+	task(task&& other) noexcept : coroutine(other.coroutine)
+	{
+		other.coroutine = nullptr;
+	}
+
+	task& operator = (task&& other) noexcept
+	{
+		if( this != &other )
+		{
+			if( coroutine )
+			{
+				coroutine.destroy();
+			}
+			coroutine = other.coroutine;
+			other.coroutine = nullptr;
+		}
+		return *this;
+	}
+
+	task(const task&) = delete;
+	task& operator = (const task&) = delete;
+
+	~task()
+	{
+		if( coroutine )
+		{
+			coroutine.destroy();
+		}
+	}
+
+	awaiter operator co_await() const noexcept
+	{
+		return awaiter{coroutine};
+	}
+};
+
+template<typename T>
+task<T> task_promise<T>::get_return_object()
+{
+	return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object()
+{
+	return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+}
+
+/*
+ * A coroutine that starts at once and frees itself when it finishes, used by start(). It is the
+ * root of the chain of tasks it awaits, and owns their frames through the task<T> it was given.
+ */
+struct detached_coroutine
+{
+	struct promise_type : public coroutine_link
+	{
+		task_state_base* state;
+
+		/* Built from run_into()'s arguments */
+		template<typename T>
+		promise_type(task<T>&, task_state<T>* state_) : state(state_)
+		{
+			abandon_chain = &abandon_root;
+		}
+
+		/* Destroying our frame destroys the task we await, and with it everything it awaits */
+		static void abandon_root(coroutine_link* root)
+		{
+			promise_type& p = static_cast<promise_type&>(*root);
+			task_state_base* const s = p.state;
+			std::coroutine_handle<promise_type>::from_promise(p).destroy();
+			s->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+			s->release();
+		}
+
+		static void* operator new(std::size_t size)
+		{
+			return slab_allocator::allocate(size);
+		}
+
+		static void operator delete(void* p)
+		{
+			slab_allocator::deallocate(p);
+		}
+
+		detached_coroutine get_return_object() const noexcept
+		{
+			return detached_coroutine();
+		}
+
+		std::suspend_never initial_suspend() const noexcept
+		{
+			return std::suspend_never();
+		}
+
+		std::suspend_never final_suspend() const noexcept
+		{
+			return std::suspend_never();
+		}
+
+		void return_void() const noexcept
+		{}
+
+		void unhandled_exception() const noexcept
+		{
+			std::terminate();
+		}
+	};
+};
+
+template<typename T>
+detached_coroutine run_into(task<T> t, task_state<T>* state)
+{
+	try
+	{
+		if constexpr( std::is_void<T>::value )
+		{
+			co_await t;
+			state->set_value();
+		}
+		else
+		{
+			state->set_value(co_await t);
+		}
+	}
+	catch(...)
+	{
+		state->set_exception(std::current_exception());
+	}
+	state->release();
+}
+
+/*
+ * Run t on the calling thread until it first suspends, and return a handle to its result. Pass
+ * the pool t runs on so that get() from one of its workers helps instead of blocking.
+ */
+template<typename T>
+task_handle<T> start(task<T> t, pending_task_runner* pool = nullptr)
+{
+	task_state<T>* const state = slab_new<task_state<T>>();
+	run_into(std::move(t), state);
+	return task_handle<T>(state, pool);
+}
+
+#endif /* POOL_COROUTINES_CC */
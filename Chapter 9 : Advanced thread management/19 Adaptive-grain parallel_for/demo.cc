@@ -0,0 +1,127 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Element costs from about a nanosecond to a millisecond, with about 20 ms of work in total for each.
+ * Every row is run three ways :
+ * 1. serial : a plain loop on the calling thread.
+ * 2. block 25 : submit_range() with 25 elements per task, the fixed block size of ../3.
+ * 3. adaptive : parallel_for() with lazy binary splitting.
+ * Then a tiny loop of 100 cheap elements, called many times, to show what parallel_for() costs when
+ * there is nothing worth splitting.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "parallel_for.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+/* About rounds * a few cycles of dependent multiplies, which the compiler cannot skip */
+inline std::uint64_t spin(std::uint64_t x, std::uint64_t rounds)
+{
+	for( std::uint64_t r = 0 ; r < rounds ; r++ )
+	{
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+	return x;
+}
+
+double rounds_per_ns()
+{
+	std::uint64_t const rounds = 50000000;
+	clock_type::time_point const start = clock_type::now();
+	std::uint64_t volatile sink = spin(1, rounds);
+	(void)sink;
+	clock_type::time_point const stop = clock_type::now();
+	return rounds / std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+template<typename Function>
+double time_ms(Function f)
+{
+	clock_type::time_point const start = clock_type::now();
+	f();
+	clock_type::time_point const stop = clock_type::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	double const total_ns = argc > 1 ? std::atof(argv[1]) * 1e6 : 20e6;
+	thread_pool pool;
+	double const speed = rounds_per_ns();
+
+	std::cout << "element cost   elements      serial    block 25    adaptive   (ms)" << std::endl;
+	double const costs_ns[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+	for( double cost : costs_ns )
+	{
+		std::uint64_t const rounds = static_cast<std::uint64_t>(cost * speed) ? static_cast<std::uint64_t>(cost * speed) : 1;
+		std::size_t const n = static_cast<std::size_t>(total_ns / cost);
+		std::vector<std::uint64_t> out(n);
+
+		double const serial = time_ms([&]
+		{
+			for( std::size_t i = 0 ; i < n ; i++ )
+			{
+				out[i] = spin(i, rounds);
+			}
+		});
+		double const blocked = time_ms([&]
+		{
+			pool.submit_range(0, n, [&out, rounds](std::size_t i) { out[i] = spin(i, rounds); }, 25).get();
+		});
+		double const adaptive = time_ms([&]
+		{
+			parallel_for(pool, std::size_t(0), n, [&out, rounds](std::size_t begin, std::size_t end)
+			{
+				for( std::size_t i = begin ; i < end ; i++ )
+				{
+					out[i] = spin(i, rounds);
+				}
+			});
+		});
+		std::cout << std::fixed << std::setprecision(0) << std::setw(9) << cost << " ns" << std::setw(11) << n << std::setprecision(2)
+				  << std::setw(12) << serial << std::setw(12) << blocked << std::setw(12) << adaptive
+				  << std::defaultfloat << std::endl;
+	}
+
+	/* A loop far too small to be worth a task, called over and over */
+	std::size_t const calls = 100000;
+	std::vector<std::uint64_t> small(100);
+	double const serial = time_ms([&]
+	{
+		for( std::size_t c = 0 ; c < calls ; c++ )
+		{
+			for( std::size_t i = 0 ; i < small.size() ; i++ )
+			{
+				small[i] = spin(i + c, 1);
+			}
+		}
+	});
+	double const adaptive = time_ms([&]
+	{
+		for( std::size_t c = 0 ; c < calls ; c++ )
+		{
+			parallel_for(pool, small.begin(), small.end(), [c](std::vector<std::uint64_t>::iterator begin,
+															 std::vector<std::uint64_t>::iterator end)
+			{
+				for( ; begin != end ; ++begin )
+				{
+					*begin = spin(*begin + c, 1);
+				}
+			});
+		}
+	});
+	std::cout << "100 elements of ~1 ns : serial " << serial * 1e6 / calls << " ns per loop, parallel_for "
+			  << adaptive * 1e6 / calls << " ns per loop" << std::endl;
+	return 0;
+}
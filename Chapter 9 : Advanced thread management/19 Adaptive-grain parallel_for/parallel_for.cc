@@ -0,0 +1,112 @@
+/*
+ * parallel_for.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+parallel_accumulate in ../3 cuts the range into blocks of 25 elements, whatever an element costs.
+For a cheap body that is thousands of tasks that each cost more to queue than to run. For an
+expensive body with few elements, it can leave workers idle. The right block size depends on the
+body, the data and how busy the pool is, and none of those are known when the code is written.
+
+parallel_for(pool, first, last, body) calls body(begin, end) on sub-ranges of [first, last) and
+picks the sub-ranges as it goes, using lazy binary splitting :
+1. The thread holding a range runs it one chunk at a time. Between chunks it asks the pool whether a
+   thief would find anything on its deque (thread_pool::wants_more_work()). Only if not does it
+   split the range in half and hand the upper half to a task_group (../16). Busy workers keep
+   their deques non-empty, so they stop splitting and just run chunks.
+2. The first chunk is one element. Each chunk is timed, and the next one is sized to take about
+   options.chunk_ns (growing at most 16 times per step), so the clock is read once per chunk and
+   looking at the pool costs a small fraction of the work. The same timings estimate the work left
+   in the range.
+3. A range is never split if its estimated remaining work is below options.min_split_ns, which
+   should be well above the cost of a task. A small loop therefore runs on the calling
+   thread with no task at all, and a large one keeps splitting as long as workers come looking.
+A handed-off half inherits the chunk size and estimate, so it does not start again from one element.
+If body throws, the rest of the loop is cancelled and the first exception is rethrown.
+ */
+#ifndef PARALLEL_FOR_CC
+#define PARALLEL_FOR_CC
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "../16 Fork-join task groups/task_group.cc"
+
+struct grain_options
+{
+	std::uint64_t chunk_ns;				// aim for chunks at least this long between looks at the pool
+	std::uint64_t min_split_ns;			// do not hand off less estimated work than this
+
+	grain_options(std::uint64_t chunk_ns_ = 2000, std::uint64_t min_split_ns_ = 20000) :
+		chunk_ns(chunk_ns_), min_split_ns(min_split_ns_)
+	{}
+};
+
+/* The shared part of one parallel_for() call. Every handed-off half refers to it */
+template<typename Index, typename Body>
+class adaptive_loop
+{
+	static std::size_t const max_chunk_growth = 16;
+
+	thread_pool& pool;
+	Body& body;
+	grain_options const options;
+	task_group group;		// last, so it waits for the children before the rest goes away
+
+public:
+	adaptive_loop(thread_pool& pool_, Body& body_, grain_options const& options_) :
+		pool(pool_), body(body_), options(options_), group(pool_)
+	{}
+
+	/* element_ns == 0 means no chunk of this range has been timed yet */
+	void run(Index first, Index last, std::size_t chunk, double element_ns)
+	{
+		std::uint64_t chunk_start = now_ns();
+		while( first != last && !group.is_cancelling() )
+		{
+			std::size_t const remaining = static_cast<std::size_t>(last - first);
+			if( remaining > 1 && element_ns * remaining >= 2.0 * options.min_split_ns && pool.wants_more_work() )
+			{
+				Index const middle = first + remaining / 2;
+				group.run([this, middle, last, chunk, element_ns] { run(middle, last, chunk, element_ns); });
+				last = middle;
+				continue;
+			}
+
+			std::size_t const n = std::min(chunk, remaining);
+			Index const chunk_end = first + n;
+			body(first, chunk_end);
+			first = chunk_end;
+
+			std::uint64_t const chunk_stop = now_ns();
+			std::uint64_t const took = chunk_stop - chunk_start;
+			chunk_start = chunk_stop;
+			element_ns = static_cast<double>(took ? took : 1) / n;
+
+			/* Size the next chunk from the estimate, but do not trust one cheap chunk too far */
+			double const target = options.chunk_ns / element_ns;
+			chunk = target < 1.0 ? 1 : std::min(static_cast<std::size_t>(target), chunk * max_chunk_growth);
+		}
+	}
+
+	void wait()
+	{
+		group.wait();
+	}
+};
+
+/*
+ * body(begin, end) is called for disjoint sub-ranges that together cover [first, last), from the
+ * calling thread and from the pool. Index is an integer or a random access iterator.
+ */
+template<typename Index, typename Body>
+void parallel_for(thread_pool& pool, Index first, Index last, Body body, grain_options const& options = grain_options())
+{
+	/* If our own chunk throws, the task_group destructor cancels and waits for the children */
+	adaptive_loop<Index, Body> loop(pool, body, options);
+	loop.run(first, last, 1, 0.0);
+	loop.wait();
+}
+
+#endif /* PARALLEL_FOR_CC */
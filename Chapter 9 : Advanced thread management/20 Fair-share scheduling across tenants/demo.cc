@@ -0,0 +1,103 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * 1. One tenant floods the pool with 50 us tasks, about half a second of work per worker. A small
+ *    tenant submits a short request every 2 ms, and we record how long each request waits between
+ *    submit() and starting :
+ *    a. both on the default tenant, which is what a single FIFO queue gives you.
+ *    b. each on its own tenant, same weight.
+ *    c. the same, with the flooding tenant capped at half the workers.
+ * 2. Two busy tenants with weights 3 and 1. The first runs 20 us tasks, the second 200 us ones.
+ *    They should still split the cpu time about 3 : 1.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "fair_share_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+void spin_for(std::chrono::microseconds duration)
+{
+	clock_type::time_point const end = clock_type::now() + duration;
+	while( clock_type::now() < end )
+	{}
+}
+
+enum class setup { one_fifo, tenants, capped_tenants };
+
+void measure(char const* name, setup how)
+{
+	unsigned const workers = std::max(std::thread::hardware_concurrency(), 1u);
+	fair_share_pool pool(workers);
+	tenant_id flood = fair_share_pool::default_tenant;
+	tenant_id small = fair_share_pool::default_tenant;
+	if( how != setup::one_fifo )
+	{
+		flood = pool.add_tenant(1, how == setup::capped_tenants ? std::max(workers / 2, 1u) : 0);
+		small = pool.add_tenant(1);
+	}
+
+	std::vector<task_handle<void>> batch;
+	for( unsigned i = 0 ; i < 10000 * workers ; i++ )
+	{
+		batch.push_back(pool.submit(flood, [] { spin_for(std::chrono::microseconds(50)); }));
+	}
+
+	std::vector<task_handle<clock_type::time_point>> requests;
+	std::vector<clock_type::time_point> submitted;
+	for( unsigned i = 0 ; i < 100 ; i++ )
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		submitted.push_back(clock_type::now());
+		requests.push_back(pool.submit(small, [] { return clock_type::now(); }));
+	}
+
+	std::vector<double> latencies;
+	for( unsigned i = 0 ; i < requests.size() ; i++ )
+	{
+		latencies.push_back(std::chrono::duration<double, std::micro>(requests[i].get() - submitted[i]).count());
+	}
+	std::sort(latencies.begin(), latencies.end());
+	tenant_stats const flooded = pool.stats(flood);
+	std::cout << std::fixed << std::setprecision(0) << name << " : request wait p50 " << latencies[latencies.size()/2] << " us, p99 "
+			  << latencies[latencies.size()*99/100] << " us, flood tasks done by then " << flooded.completed << std::endl;
+
+	/* Nobody wants the rest of the flood, let the pool drop it */
+	batch.clear();
+}
+
+int main(int argc, char **argv)
+{
+	measure("one FIFO            ", setup::one_fifo);
+	measure("tenants             ", setup::tenants);
+	measure("tenants, flood capped", setup::capped_tenants);
+
+	fair_share_pool pool;
+	tenant_id const heavy = pool.add_tenant(3);
+	tenant_id const light = pool.add_tenant(1);
+	std::vector<task_handle<void>> tasks;
+	for( unsigned i = 0 ; i < 20000 ; i++ )
+	{
+		tasks.push_back(pool.submit(heavy, [] { spin_for(std::chrono::microseconds(20)); }));
+		if( i % 10 == 0 )
+		{
+			tasks.push_back(pool.submit(light, [] { spin_for(std::chrono::microseconds(200)); }));
+		}
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	tenant_stats const a = pool.stats(heavy);
+	tenant_stats const b = pool.stats(light);
+	std::cout << "weights 3 : 1 -> cpu time " << a.run_ns / 1000000 << " ms : " << b.run_ns / 1000000 << " ms ("
+			  << a.completed << " short tasks, " << b.completed << " long tasks)" << std::endl;
+	tasks.clear();
+	return 0;
+}
@@ -0,0 +1,309 @@
+/*
+ * fair_share_pool.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+When independent clients share one pool, its queue is a single FIFO. A client that submits
+ten thousand tasks puts every other client's next task behind all of them. The priority lanes in
+../11 do not help, because the clients are peers and none of them is "high".
+
+This pool gives every client ("tenant") its own queue and shares the workers between the queues :
+1. add_tenant(weight, max_in_flight) registers a tenant, and submit(tenant, f) queues f on
+   that tenant's queue.
+2. Workers pick the next queue by weighted deficit round robin. Tenants with queued work take turns
+   in a ring. At the start of its turn a tenant is credited weight * quantum_ns of cpu time, and
+   it keeps the turn while its credit lasts.
+   Task lengths are not known in advance, so each pop is charged the tenant's average task time,
+   and the difference is settled when the task finishes. A tenant of long tasks and a tenant
+   of short ones with the same weight get about the same cpu time, not the same number of tasks.
+   A tenant in debt sits out whole turns until it is paid off. A zero weight or quantum is taken as
+   1, so every turn adds some credit and a pick always ends.
+3. max_in_flight caps how many of a tenant's tasks run at once (0 = no cap). A capped tenant
+   leaves the ring until one of its tasks finishes. A flooding tenant capped below the worker count
+   always leaves workers free for the others.
+Tenant 0 is the default tenant (weight 1, no cap). submit() without a tenant and continuations
+(../14) go there.
+All queues and the ring sit behind one mutex, held only to push or pick. Idle workers park on an
+eventcount (../7) and submit() returns a task_handle<> (../10).
+A task that waits for a child of its own tenant can deadlock if the tenant is capped.
+ */
+#ifndef FAIR_SHARE_POOL_CC
+#define FAIR_SHARE_POOL_CC
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef unsigned tenant_id;
+
+struct tenant_stats
+{
+	std::uint64_t submitted;
+	std::uint64_t completed;
+	std::uint64_t queued;
+	std::uint64_t in_flight;
+	std::uint64_t run_ns;			// total time spent running this tenant's tasks
+};
+
+class fair_share_pool : public pending_task_runner
+{
+	typedef function_wrapper task_type;
+
+	struct tenant
+	{
+		unsigned const weight;
+		unsigned const max_in_flight;		// 0 for no cap
+		std::deque<task_type> queue;
+		bool in_ring;
+		std::int64_t deficit;				// ns of credit left this turn, negative while in debt
+		std::uint64_t average_ns;			// what a pop is charged up front
+		tenant_stats stats;
+
+		tenant(unsigned weight_, unsigned max_in_flight_) :
+			weight(std::max(weight_, 1u)), max_in_flight(max_in_flight_), in_ring(false), deficit(0),
+			average_ns(1000), stats()
+		{}
+
+		bool runnable() const
+		{
+			return !queue.empty() && (max_in_flight == 0 || stats.in_flight < max_in_flight);
+		}
+	};
+
+	/* What a worker takes out of the scheduler, and hands back once it has run */
+	struct picked_task
+	{
+		task_type task;
+		tenant_id owner;
+		std::uint64_t charged_ns;
+	};
+
+	std::atomic_bool done;
+	std::uint64_t const quantum_ns;
+	idle_options const idle;
+	eventcount work_available;
+	mutable std::mutex m;
+	std::vector<std::unique_ptr<tenant>> tenants;
+	std::deque<tenant_id> ring;						// tenants that are runnable(), in turn order
+	std::atomic<unsigned> ring_size;				// for parking without the lock
+	std::vector<std::thread> threads;
+	join_threads joiner;
+
+	static thread_local fair_share_pool* current_pool;
+
+	void worker_thread()
+	{
+		current_pool = this;
+
+		idle_backoff backoff(idle);
+		while( !done )
+		{
+			if( run_pending_task() )
+			{
+				backoff.reset();
+			}
+			else if( !backoff.backoff() )
+			{
+				work_available.wait([this] { return done || ring_size.load(std::memory_order_relaxed) != 0; });
+				backoff.reset();
+			}
+		}
+		current_pool = nullptr;
+	}
+
+	/* Under the lock */
+	void join_ring(tenant_id id)
+	{
+		tenant& t = *tenants[id];
+		if( !t.in_ring && t.runnable() )
+		{
+			t.in_ring = true;
+			ring.push_back(id);
+			ring_size.store(ring.size(), std::memory_order_relaxed);
+		}
+	}
+
+	void push(tenant_id id, task_type task)
+	{
+		{
+			std::lock_guard<std::mutex> lk(m);
+			tenant& t = *tenants[id];
+			t.queue.push_back(std::move(task));
+			t.stats.submitted++;
+			join_ring(id);
+		}
+		work_available.notify_one();
+	}
+
+	bool pick(picked_task& picked)
+	{
+		std::lock_guard<std::mutex> lk(m);
+		while( !ring.empty() )
+		{
+			tenant_id const id = ring.front();
+			tenant& t = *tenants[id];
+
+			/* A new turn : add this turn's credit, and sit it out if that does not clear the debt */
+			if( t.deficit <= 0 )
+			{
+				t.deficit += static_cast<std::int64_t>(t.weight * quantum_ns);
+				if( t.deficit <= 0 )
+				{
+					ring.pop_front();
+					ring.push_back(id);
+					continue;
+				}
+			}
+
+			picked.task = std::move(t.queue.front());
+			t.queue.pop_front();
+			picked.owner = id;
+			picked.charged_ns = t.average_ns;
+			t.deficit -= static_cast<std::int64_t>(t.average_ns);
+			t.stats.in_flight++;
+
+			ring.pop_front();
+			if( !t.runnable() )
+			{
+				t.in_ring = false;
+				if( t.queue.empty() && t.deficit > 0 )
+				{
+					t.deficit = 0;		// unused credit does not carry over an idle spell
+				}
+			}
+			else if( t.deficit > 0 )
+			{
+				ring.push_front(id);		// still our turn
+			}
+			else
+			{
+				ring.push_back(id);
+			}
+			ring_size.store(ring.size(), std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	/* Settle the charge, and let a capped tenant back into the ring */
+	void finished(picked_task const& picked, std::uint64_t run_ns)
+	{
+		bool rejoined = false;
+		{
+			std::lock_guard<std::mutex> lk(m);
+			tenant& t = *tenants[picked.owner];
+			t.deficit -= static_cast<std::int64_t>(run_ns) - static_cast<std::int64_t>(picked.charged_ns);
+			t.average_ns = (7 * t.average_ns + run_ns) / 8 + 1;
+			t.stats.in_flight--;
+			t.stats.completed++;
+			t.stats.run_ns += run_ns;
+			rejoined = !t.in_ring && t.runnable();
+			join_ring(picked.owner);
+		}
+		if( rejoined )
+		{
+			work_available.notify_one();
+		}
+	}
+
+public:
+	static tenant_id const default_tenant = 0;
+
+	explicit fair_share_pool(unsigned thread_count = std::max(std::thread::hardware_concurrency(), 1u),
+							 std::uint64_t quantum_ns_ = 100000,
+							 idle_options idle_ = idle_options()) :
+		done(false), quantum_ns(std::max<std::uint64_t>(quantum_ns_, 1)), idle(idle_), ring_size(0), joiner(threads)
+	{
+		tenants.push_back(std::unique_ptr<tenant>(new tenant(1, 0)));
+		try
+		{
+			for( unsigned i = 0 ; i < thread_count ; i++ )
+			{
+				threads.push_back(std::thread(&fair_share_pool::worker_thread, this));
+			}
+		}
+		catch(...)
+		{
+			done = true;
+			work_available.notify_all();
+			throw;
+		}
+	}
+
+	~fair_share_pool()
+	{
+		done = true;
+		work_available.notify_all();
+	}
+
+	/* weight is relative to the other tenants, max_in_flight = 0 for no cap */
+	tenant_id add_tenant(unsigned weight = 1, unsigned max_in_flight = 0)
+	{
+		std::lock_guard<std::mutex> lk(m);
+		tenants.push_back(std::unique_ptr<tenant>(new tenant(weight, max_in_flight)));
+		return static_cast<tenant_id>(tenants.size() - 1);
+	}
+
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(tenant_id id, FunctionType f)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		push(id, task_type(task_body<FunctionType, result_type>(std::move(f), state)));
+		return task_handle<result_type>(state, this);
+	}
+
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(FunctionType f)
+	{
+		return submit(default_tenant, std::move(f));
+	}
+
+	tenant_stats stats(tenant_id id) const
+	{
+		std::lock_guard<std::mutex> lk(m);
+		tenant_stats s = tenants[id]->stats;
+		s.queued = tenants[id]->queue.size();
+		return s;
+	}
+
+	bool run_pending_task() override
+	{
+		picked_task picked;
+		if( !pick(picked) )
+		{
+			return false;
+		}
+		std::uint64_t const start = now_ns();
+		picked.task();
+		finished(picked, now_ns() - start);
+		return true;
+	}
+
+	void schedule(scheduled_continuation* c) override
+	{
+		if( done )
+		{
+			c->abandon();
+			return;
+		}
+		push(default_tenant, task_type(continuation_task(c)));
+	}
+
+	bool is_pool_thread() const override
+	{
+		return current_pool == this;
+	}
+};
+
+thread_local fair_share_pool* fair_share_pool::current_pool = nullptr;
+
+#endif /* FAIR_SHARE_POOL_CC */
@@ -0,0 +1,116 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * The data is cut into shards of 128 KB, four per worker, so one worker's shards fit in its L2 but
+ * all of them together do not. Think of the bucket ranges of threadsafe_lookup_table in Chapter 6.
+ * Every round submits one task per shard that walks a random cycle through the shard, so every
+ * step is a dependent load. Then we wait for the whole round.
+ * 1. submit() : whichever worker is free takes the task, so a shard moves from core to core between
+ *    rounds and each task starts on cold caches.
+ * 2. submit_affine(shard) : a shard always goes to the same worker and finds its lines still in
+ *    that core's L2.
+ * It prints the time per step for both. On a single core both use the same cache, so expect no
+ * difference there.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+struct shard
+{
+	std::vector<std::uint32_t> next;		// a single random cycle through every slot
+	std::uint32_t position;
+
+	explicit shard(std::size_t slots, std::mt19937& rng) : next(slots), position(0)
+	{
+		std::vector<std::uint32_t> order(slots);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), rng);
+		for( std::size_t i = 0 ; i < slots ; i++ )
+		{
+			next[order[i]] = order[(i + 1) % slots];
+		}
+	}
+
+	void walk(unsigned steps)
+	{
+		std::uint32_t p = position;
+		for( unsigned i = 0 ; i < steps ; i++ )
+		{
+			p = next[p];
+		}
+		position = p;
+	}
+};
+
+double measure(thread_pool& pool, std::vector<shard>& shards, unsigned rounds, unsigned steps, bool affine)
+{
+	clock_type::time_point const start = clock_type::now();
+	std::vector<task_handle<void>> handles;
+	for( unsigned r = 0 ; r < rounds ; r++ )
+	{
+		handles.clear();
+		for( std::size_t s = 0 ; s < shards.size() ; s++ )
+		{
+			shard* const target = &shards[s];
+			if( affine )
+			{
+				handles.push_back(pool.submit_affine(s, [target, steps] { target->walk(steps); }));
+			}
+			else
+			{
+				handles.push_back(pool.submit([target, steps] { target->walk(steps); }));
+			}
+		}
+		for( std::size_t i = 0 ; i < handles.size() ; i++ )
+		{
+			handles[i].get();
+		}
+	}
+	clock_type::time_point const stop = clock_type::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (double(rounds) * shards.size() * steps);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned const rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+	std::size_t const shard_bytes = 128 * 1024;
+	unsigned const steps = 32768;
+
+	thread_pool pool;
+	std::mt19937 rng(42);
+	std::vector<shard> shards;
+	for( unsigned i = 0 ; i < 4 * pool.worker_count() ; i++ )
+	{
+		shards.push_back(shard(shard_bytes / sizeof(std::uint32_t), rng));
+	}
+
+	/* Once unmeasured so both runs start from the same place */
+	measure(pool, shards, 2, steps, false);
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << shards.size() << " shards of " << shard_bytes / 1024 << " KB on " << pool.worker_count() << " workers" << std::endl;
+	double const anywhere = measure(pool, shards, rounds, steps, false);
+	worker_stats const before = pool.stats().total;
+	double const affine = measure(pool, shards, rounds, steps, true);
+	worker_stats const after = pool.stats().total;
+	std::cout << "submit()        : " << anywhere << " ns per step" << std::endl;
+	std::cout << "submit_affine() : " << affine << " ns per step, "
+			  << after.inbox_pops - before.inbox_pops << " tasks run from worker inboxes" << std::endl;
+	return 0;
+}
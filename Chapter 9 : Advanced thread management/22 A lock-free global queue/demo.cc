@@ -0,0 +1,83 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Scalability of the global queue from 1 to 64 threads. Every thread repeatedly pushes a
+ * function_wrapper and pops one (not necessarily its own), which is what submitters and idle
+ * workers do to pool_work_queue. The total number of operations stays the same and is split over
+ * the threads, for :
+ * 1. thread_safe_queue, the mutex-protected queue the pool used before.
+ * 2. mpmc_queue with room for every item, so only the lock-free array is used.
+ * 3. mpmc_queue with 16 cells, so most items go through the locked overflow list.
+ * It prints millions of push+pop pairs per second. Past the number of cores the threads also
+ * fight over the cpu, and a thread preempted while holding the mutex stalls all the others.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+template<typename Queue>
+double pairs_per_us(Queue& queue, unsigned thread_count, unsigned long total_pairs)
+{
+	unsigned long const per_thread = total_pairs / thread_count;
+	std::atomic<bool> go(false);
+	std::vector<std::thread> threads;
+	for( unsigned t = 0 ; t < thread_count ; t++ )
+	{
+		threads.push_back(std::thread([&queue, &go, per_thread]
+		{
+			while( !go.load(std::memory_order_acquire) )
+			{
+				std::this_thread::yield();
+			}
+			function_wrapper popped;
+			for( unsigned long i = 0 ; i < per_thread ; i++ )
+			{
+				queue.push(function_wrapper([i] { (void)i; }));
+				while( !queue.try_pop(popped) )
+				{
+					std::this_thread::yield();		// another thread took ours, one of theirs is on its way
+				}
+			}
+		}));
+	}
+
+	clock_type::time_point const start = clock_type::now();
+	go.store(true, std::memory_order_release);
+	for( unsigned t = 0 ; t < thread_count ; t++ )
+	{
+		threads[t].join();
+	}
+	clock_type::time_point const stop = clock_type::now();
+	return double(per_thread) * thread_count / std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const total_pairs = argc > 1 ? std::atol(argv[1]) : 2000000;
+	std::cout << "cores : " << std::thread::hardware_concurrency() << ", millions of push+pop pairs per second" << std::endl;
+	std::cout << "threads  thread_safe_queue  mpmc_queue  mpmc_queue (16 cells)" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for( unsigned threads = 1 ; threads <= 64 ; threads *= 2 )
+	{
+		thread_safe_queue<function_wrapper> locked;
+		mpmc_queue<function_wrapper> lock_free(128);
+		mpmc_queue<function_wrapper> overflowing(16);
+		double const a = pairs_per_us(locked, threads, total_pairs);
+		double const b = pairs_per_us(lock_free, threads, total_pairs);
+		double const c = pairs_per_us(overflowing, threads, total_pairs);
+		std::cout << std::setw(7) << threads << std::setw(19) << a << std::setw(12) << b << std::setw(23) << c << std::endl;
+	}
+	return 0;
+}
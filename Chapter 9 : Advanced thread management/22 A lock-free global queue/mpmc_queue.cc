@@ -0,0 +1,265 @@
+/*
+ * mpmc_queue.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+pool_work_queue in ../6 is a thread_safe_queue : a std::queue behind one mutex. Every thread
+outside the pool that submits, and every idle worker that has found nothing to steal, takes that
+one lock. While one of them holds it, the others block in the kernel.
+
+mpmc_queue is a drop-in replacement (push, push_range, try_pop, empty, size) :
+1. The fast path is Dmitry Vyukov's bounded multi-producer multi-consumer array queue. Every cell
+   carries a sequence number that says whose turn it is : a producer whose ticket matches
+   writes the cell, and the consumer with the next ticket reads it. A push or pop is one
+   compare-and-swap on enqueue_pos or dequeue_pos, plus an acquire load and a release store on the
+   cell. No thread ever waits for another to leave a critical section.
+2. The array has a fixed capacity (a power of two). A push that finds it full goes to an
+   unbounded overflow list behind a mutex instead of failing. While the overflow list is
+   non-empty, new pushes go there too, so older items in the array are served first and
+   overflowed items are not starved. Once the overflow drains, pushes return to the array. The
+   lock is only taken while more than capacity items are queued.
+3. push_range() claims a run of free cells with a single compare-and-swap and fills them in order,
+   and puts whatever does not fit onto the overflow list under one lock.
+4. Order is FIFO per producer, except around the switch to and from the overflow list, where a
+   few items may be reordered. The pool does not rely on more than that.
+empty() and size() read the two positions without locking, so they are approximate, like
+work_stealing_queue::size().
+ */
+#ifndef MPMC_QUEUE_CC
+#define MPMC_QUEUE_CC
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <utility>
+
+template<typename T>
+class mpmc_queue
+{
+	struct cell
+	{
+		std::atomic<std::size_t> sequence;
+		T data;
+	};
+
+	/* Producers and consumers each hammer their own position, keep them off each other's line */
+	alignas(64) std::atomic<std::size_t> enqueue_pos;
+	alignas(64) std::atomic<std::size_t> dequeue_pos;
+	alignas(64) std::atomic<std::size_t> overflow_count;
+	std::size_t const mask;
+	std::unique_ptr<cell[]> cells;
+	std::mutex overflow_mutex;
+	std::queue<T> overflow;
+
+	static std::size_t round_up_to_power_of_2(std::size_t n)
+	{
+		std::size_t p = 2;
+		while( p < n )
+		{
+			p <<= 1;
+		}
+		return p;
+	}
+
+	bool try_push_array(T& value)
+	{
+		std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		for( ;; )
+		{
+			cell& c = cells[pos & mask];
+			std::size_t const seq = c.sequence.load(std::memory_order_acquire);
+			std::intptr_t const diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+			if( diff == 0 )
+			{
+				if( enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				{
+					c.data = std::move(value);
+					c.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if( diff < 0 )
+			{
+				return false;		// full : the consumer a whole lap behind has not read this cell yet
+			}
+			else
+			{
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool try_pop_array(T& value)
+	{
+		std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		for( ;; )
+		{
+			cell& c = cells[pos & mask];
+			std::size_t const seq = c.sequence.load(std::memory_order_acquire);
+			std::intptr_t const diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+			if( diff == 0 )
+			{
+				if( dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				{
+					value = std::move(c.data);
+					c.sequence.store(pos + mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if( diff < 0 )
+			{
+				return false;		// empty, or the producer of this cell has not finished writing it
+			}
+			else
+			{
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/*
+	 * Claim up to want consecutive cells from enqueue_pos on, with one compare-and-swap. Only cells that
+	 * the consumers of the previous lap have already released are taken. Returns how many cells were
+	 * claimed, the first one is pos, or 0 if the array is full.
+	 */
+	std::size_t claim_array(std::size_t want, std::size_t& pos)
+	{
+		pos = enqueue_pos.load(std::memory_order_relaxed);
+		for( ;; )
+		{
+			std::size_t n = 0;
+			while( n < want && cells[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n )
+			{
+				n++;
+			}
+			if( n == 0 )
+			{
+				std::size_t const seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+				if( static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) < 0 )
+				{
+					return 0;
+				}
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+				continue;
+			}
+			if( enqueue_pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed) )
+			{
+				return n;
+			}
+		}
+	}
+
+	void push_overflow(T&& value)
+	{
+		std::lock_guard<std::mutex> lk(overflow_mutex);
+		overflow.push(std::move(value));
+		overflow_count.fetch_add(1, std::memory_order_release);
+	}
+
+	/* The rest of a batch, under a single lock */
+	template<typename Iterator>
+	void push_overflow_range(Iterator first, Iterator last)
+	{
+		std::lock_guard<std::mutex> lk(overflow_mutex);
+		std::size_t count = 0;
+		for( ; first != last ; ++first, ++count )
+		{
+			overflow.push(std::move(*first));
+		}
+		overflow_count.fetch_add(count, std::memory_order_release);
+	}
+
+	bool try_pop_overflow(T& value)
+	{
+		std::lock_guard<std::mutex> lk(overflow_mutex);
+		if( overflow.empty() )
+		{
+			return false;
+		}
+		value = std::move(overflow.front());
+		overflow.pop();
+		overflow_count.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+public:
+	explicit mpmc_queue(std::size_t capacity = 4096) :
+		enqueue_pos(0), dequeue_pos(0), overflow_count(0), mask(round_up_to_power_of_2(capacity) - 1),
+		cells(new cell[mask + 1])
+	{
+		for( std::size_t i = 0 ; i <= mask ; i++ )
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	mpmc_queue(const mpmc_queue&) = delete;
+	mpmc_queue& operator = (const mpmc_queue&) = delete;
+
+	void push(T new_value)
+	{
+		if( overflow_count.load(std::memory_order_acquire) != 0 || !try_push_array(new_value) )
+		{
+			push_overflow(std::move(new_value));
+		}
+	}
+
+	/*
+	 * Move every element of [first, last) in (forward iterators). Runs of free cells are claimed with
+	 * one compare-and-swap each, and whatever does not fit goes onto the overflow list under one lock.
+	 */
+	template<typename Iterator>
+	void push_range(Iterator first, Iterator last)
+	{
+		std::size_t remaining = std::distance(first, last);
+		while( remaining && overflow_count.load(std::memory_order_acquire) == 0 )
+		{
+			std::size_t pos;
+			std::size_t const claimed = claim_array(remaining, pos);
+			if( !claimed )
+			{
+				break;
+			}
+			for( std::size_t i = 0 ; i < claimed ; i++, ++first )
+			{
+				cell& c = cells[(pos + i) & mask];
+				c.data = std::move(*first);
+				c.sequence.store(pos + i + 1, std::memory_order_release);
+			}
+			remaining -= claimed;
+		}
+		if( remaining )
+		{
+			push_overflow_range(first, last);
+		}
+	}
+
+	bool try_pop(T& value)
+	{
+		if( try_pop_array(value) )
+		{
+			return true;
+		}
+		return overflow_count.load(std::memory_order_acquire) != 0 && try_pop_overflow(value);
+	}
+
+	bool empty() const
+	{
+		return dequeue_pos.load(std::memory_order_relaxed) >= enqueue_pos.load(std::memory_order_relaxed) &&
+			   overflow_count.load(std::memory_order_relaxed) == 0;
+	}
+
+	std::size_t size() const
+	{
+		std::size_t const head = dequeue_pos.load(std::memory_order_relaxed);
+		std::size_t const tail = enqueue_pos.load(std::memory_order_relaxed);
+		return (tail > head ? tail - head : 0) + overflow_count.load(std::memory_order_relaxed);
+	}
+};
+
+#endif /* MPMC_QUEUE_CC */
@@ -0,0 +1,153 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * 1. A small job : parse a block of text into numbers, then eight transforms on slices of them,
+ *    merged pairwise and then into one total. The graph is built once and run 1000 times on a
+ *    pool with a single worker, where chaining the stages with blocking get() on a std::future
+ *    would deadlock (see ../2).
+ * 2. The cost of a run, for a 1000 node graph of empty nodes in layers of 10, each node depending on
+ *    two nodes of the layer above. The graph is reused across runs, against rebuilding it for
+ *    every run.
+ * 3. A node that throws : get() on the run rethrows and the nodes after it are skipped.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "task_graph.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+/* 1000 nodes in layers of 10, each node after two nodes of the layer above */
+void build_layers(task_graph& graph, std::atomic<unsigned long>& count)
+{
+	unsigned const width = 10;
+	unsigned const depth = 100;
+	for( unsigned layer = 0 ; layer < depth ; layer++ )
+	{
+		for( unsigned i = 0 ; i < width ; i++ )
+		{
+			task_graph::node_id const id = graph.add([&count] { count.fetch_add(1, std::memory_order_relaxed); });
+			if( layer > 0 )
+			{
+				graph.precede(id - width, id);
+				graph.precede(id - i - width + (i + 1) % width, id);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned const runs = argc > 1 ? std::atoi(argv[1]) : 1000;
+	thread_pool pool(1);
+
+	std::string text;
+	for( unsigned i = 1 ; i <= 8000 ; i++ )
+	{
+		text += std::to_string(i) + " ";
+	}
+
+	unsigned const slices = 8;
+	std::vector<long> numbers;
+	std::vector<long> transformed(slices);
+	std::vector<long> merged(slices / 2);
+	long total = 0;
+
+	task_graph job;
+	task_graph::node_id const parse = job.add([&]
+	{
+		numbers.clear();
+		std::istringstream in(text);
+		for( long x ; in >> x ; )
+		{
+			numbers.push_back(x);
+		}
+	});
+	task_graph::node_id const sum = job.add([&] { total = std::accumulate(merged.begin(), merged.end(), 0l); });
+	for( unsigned m = 0 ; m < slices / 2 ; m++ )
+	{
+		task_graph::node_id const merge = job.add([&, m] { merged[m] = transformed[2 * m] + transformed[2 * m + 1]; });
+		job.precede(merge, sum);
+		for( unsigned t = 2 * m ; t < 2 * m + 2 ; t++ )
+		{
+			task_graph::node_id const transform = job.add([&, t]
+			{
+				std::size_t const size = numbers.size() / slices;
+				long squares = 0;
+				for( std::size_t i = t * size ; i < (t + 1) * size ; i++ )
+				{
+					squares += numbers[i] * numbers[i] % 1000;
+				}
+				transformed[t] = squares;
+			});
+			job.precede(parse, transform);
+			job.precede(transform, merge);
+		}
+	}
+
+	long expected = 0;
+	for( long i = 1 ; i <= 8000 ; i++ )
+	{
+		expected += i * i % 1000;
+	}
+	unsigned correct = 0;
+	for( unsigned r = 0 ; r < runs ; r++ )
+	{
+		total = 0;
+		job.run(pool).get();
+		correct += total == expected;
+	}
+	std::cout << "parse -> 8 transforms -> 4 merges -> total, " << job.size() << " nodes : "
+			  << correct << " of " << runs << " runs correct on one worker" << std::endl;
+
+	/* Per-run cost with the structure reused, and rebuilt every time */
+	std::atomic<unsigned long> count(0);
+	task_graph layers;
+	build_layers(layers, count);
+	clock_type::time_point start = clock_type::now();
+	for( unsigned r = 0 ; r < runs ; r++ )
+	{
+		layers.run(pool).get();
+	}
+	clock_type::time_point stop = clock_type::now();
+	double const reused = std::chrono::duration<double, std::nano>(stop - start).count() / (double(runs) * layers.size());
+
+	start = clock_type::now();
+	for( unsigned r = 0 ; r < runs ; r++ )
+	{
+		task_graph fresh;
+		build_layers(fresh, count);
+		fresh.run(pool).get();
+	}
+	stop = clock_type::now();
+	double const rebuilt = std::chrono::duration<double, std::nano>(stop - start).count() / (double(runs) * layers.size());
+	std::cout << layers.size() << " empty nodes : " << reused << " ns per node reusing the graph, " << rebuilt
+			  << " ns per node rebuilding it" << (count == 2ul * runs * layers.size() ? "" : ", WRONG COUNT") << std::endl;
+
+	/* A failing stage : the stages after it do not run */
+	task_graph failing;
+	bool later_ran = false;
+	task_graph::node_id const bad = failing.add([] { throw std::runtime_error("transform failed"); });
+	task_graph::node_id const after = failing.add([&later_ran] { later_ran = true; });
+	failing.precede(bad, after);
+	try
+	{
+		failing.run(pool).get();
+	}
+	catch(std::exception const& e)
+	{
+		std::cout << "get() rethrew : " << e.what() << (later_ran ? ", but the next stage ran" : ", next stage skipped") << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * task_graph.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+A job shaped like a DAG (parse, then several transforms, then merges) is easy to write as pool
+tasks that call get() on the futures of the tasks they depend on. Each waiting task holds a worker,
+though. On the pool in ../2 a std::future::get() really blocks, and once every worker is waiting
+on a task still in the queue, nothing runs again.
+
+A task_graph is declared once and run as often as needed :
+1. add(f) adds a node and returns its id. precede(a, b) adds an edge : b runs after a.
+2. run(pool) returns a task_handle<void> (../10) that becomes ready once every node has run.
+   Nothing ever waits inside the graph. Each node has an atomic count of unfinished predecessors,
+   and the node that takes a count to zero schedules that successor at once.
+   One ready successor runs on the same thread straight away, and the others are posted to
+   the pool.
+3. The structure is reused across runs. A run resets the counters, posts the nodes that have no
+   predecessors and allocates only the run's task_state (from the slab allocator). Node tasks
+   fit in the function_wrapper's inline buffer (../8).
+4. If a node throws, the nodes that have not started yet are skipped, and get() on the run's handle
+   rethrows the first exception.
+The graph must not change while a run is in progress, and runs of one graph do not overlap :
+run() throws std::logic_error if the previous run has not finished, or if the edges form a cycle.
+ */
+#ifndef TASK_GRAPH_CC
+#define TASK_GRAPH_CC
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+class task_graph
+{
+	struct node
+	{
+		std::function<void()> f;
+		std::size_t const id;
+		std::vector<node*> successors;
+		unsigned predecessors;
+		std::atomic<unsigned> pending;		// predecessors not finished yet in this run
+
+		node(std::function<void()> f_, std::size_t id_) : f(std::move(f_)), id(id_), predecessors(0), pending(0)
+		{}
+	};
+
+	/* What is posted to the pool, small enough for the function_wrapper's inline buffer */
+	struct node_task
+	{
+		task_graph* graph;
+		node* n;
+
+		void operator () ()
+		{
+			graph->execute(n);
+		}
+	};
+
+	std::vector<std::unique_ptr<node>> nodes;
+	std::vector<node*> roots;
+	bool checked;				// roots is up to date and there is no cycle
+
+	thread_pool* pool;
+	task_state<void>* run_state;
+	std::atomic<bool> running;
+	std::atomic<std::size_t> remaining;
+	std::atomic<bool> failed;
+	std::exception_ptr error;		// written once, by whoever sets failed
+
+	node* at(std::size_t id) const
+	{
+		if( id >= nodes.size() )
+		{
+			throw std::out_of_range("task_graph : no such node");
+		}
+		return nodes[id].get();
+	}
+
+	/* Kahn's algorithm : if some node is never freed, it is on a cycle */
+	void check()
+	{
+		std::vector<unsigned> pending(nodes.size());
+		std::vector<node*> ready;
+		roots.clear();
+		for( std::size_t i = 0 ; i < nodes.size() ; i++ )
+		{
+			pending[i] = nodes[i]->predecessors;
+			if( pending[i] == 0 )
+			{
+				roots.push_back(nodes[i].get());
+				ready.push_back(nodes[i].get());
+			}
+		}
+
+		std::size_t visited = 0;
+		while( !ready.empty() )
+		{
+			node* const n = ready.back();
+			ready.pop_back();
+			visited++;
+			for( std::size_t i = 0 ; i < n->successors.size() ; i++ )
+			{
+				node* const s = n->successors[i];
+				if( --pending[s->id] == 0 )
+				{
+					ready.push_back(s);
+				}
+			}
+		}
+		if( visited != nodes.size() )
+		{
+			throw std::logic_error("task_graph : the edges form a cycle");
+		}
+		checked = true;
+	}
+
+	/* Run n, then whichever successor it frees, and so on. Any other freed successors go to the pool */
+	void execute(node* n)
+	{
+		while( n )
+		{
+			if( !failed.load(std::memory_order_relaxed) )
+			{
+				try
+				{
+					n->f();
+				}
+				catch(...)
+				{
+					if( !failed.exchange(true) )
+					{
+						error = std::current_exception();
+					}
+				}
+			}
+
+			node* next = nullptr;
+			for( std::size_t i = 0 ; i < n->successors.size() ; i++ )
+			{
+				node* const s = n->successors[i];
+				if( s->pending.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+				{
+					if( next )
+					{
+						pool->post(node_task{this, next});
+					}
+					next = s;
+				}
+			}
+
+			node_done();
+			n = next;
+		}
+	}
+
+	/* The last node to finish completes the run. Nothing of ours is touched after that */
+	void node_done()
+	{
+		if( remaining.fetch_sub(1, std::memory_order_acq_rel) != 1 )
+		{
+			return;
+		}
+		task_state<void>* const state = run_state;
+		std::exception_ptr const e = error;
+		error = nullptr;
+		failed.store(false, std::memory_order_relaxed);
+		running.store(false, std::memory_order_release);
+		if( e )
+		{
+			state->set_exception(e);
+		}
+		else
+		{
+			state->set_value();
+		}
+		state->release();
+	}
+
+public:
+	typedef std::size_t node_id;
+
+	task_graph() : checked(true), pool(nullptr), run_state(nullptr), running(false), remaining(0), failed(false)
+	{}
+
+	/* The graph must outlive its runs */
+	task_graph(const task_graph&) = delete;
+	task_graph& operator = (const task_graph&) = delete;
+
+	template<typename FunctionType>
+	node_id add(FunctionType f)
+	{
+		nodes.push_back(std::unique_ptr<node>(new node(std::function<void()>(std::move(f)), nodes.size())));
+		checked = false;
+		return nodes.size() - 1;
+	}
+
+	/* after runs once before has finished */
+	void precede(node_id before, node_id after)
+	{
+		node* const a = at(before);
+		node* const b = at(after);
+		a->successors.push_back(b);
+		b->predecessors++;
+		checked = false;
+	}
+
+	std::size_t size() const
+	{
+		return nodes.size();
+	}
+
+	task_handle<void> run(thread_pool& pool_)
+	{
+		if( !checked )
+		{
+			check();
+		}
+		if( running.exchange(true, std::memory_order_acquire) )
+		{
+			throw std::logic_error("task_graph : run() while the previous run is in progress");
+		}
+
+		/* Two references : the handle's, and the one the last node releases */
+		task_state<void>* const state = slab_new<task_state<void>>();
+		if( nodes.empty() )
+		{
+			running.store(false, std::memory_order_relaxed);
+			state->set_value();
+			state->release();
+			return task_handle<void>(state, &pool_);
+		}
+
+		pool = &pool_;
+		run_state = state;
+		for( std::size_t i = 0 ; i < nodes.size() ; i++ )
+		{
+			nodes[i]->pending.store(nodes[i]->predecessors, std::memory_order_relaxed);
+		}
+		remaining.store(nodes.size(), std::memory_order_relaxed);
+
+		/* remaining counts the roots we have not posted yet, so the run cannot finish during this loop */
+		for( std::size_t i = 0 ; i < roots.size() ; i++ )
+		{
+			pool_.post(node_task{this, roots[i]});
+		}
+		return task_handle<void>(state, &pool_);
+	}
+};
+
+#endif /* TASK_GRAPH_CC */
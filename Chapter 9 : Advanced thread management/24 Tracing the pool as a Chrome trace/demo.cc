@@ -0,0 +1,107 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * The std::list quicksort from ../4 on the work-stealing pool, traced. The trace goes to
+ * pool_trace.json (or the file named by the second argument). Load it in ui.perfetto.dev or
+ * chrome://tracing and look for :
+ * 1. the first partition, a single task on one worker while the others are parked,
+ * 2. stealing spreading the recursion out, one steal marker per handed-over half,
+ * 3. the tail, where the threads wait in get() for the last, largest halves.
+ * It also times the sort with tracing never started and with it on, and 200000 empty tasks
+ * both ways, to show what recording costs.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+/* As ../4, with a task_handle<> whose get() runs other tasks while it waits */
+template<typename T>
+std::list<T> do_sort(thread_pool& pool, std::list<T> chunk_data)
+{
+	if( chunk_data.size() < 2 )
+	{
+		return chunk_data;
+	}
+
+	std::list<T> result;
+	result.splice(result.begin(), chunk_data, chunk_data.begin());
+	T const& partition_val = *result.begin();
+	typename std::list<T>::iterator divide_point = std::partition(chunk_data.begin(), chunk_data.end(),
+																	[&](T const& val) { return val < partition_val; });
+	std::list<T> new_lower_chunk;
+	new_lower_chunk.splice(new_lower_chunk.end(), chunk_data, chunk_data.begin(), divide_point);
+
+	task_handle<std::list<T>> new_lower = pool.submit([&pool, lower = std::move(new_lower_chunk)]() mutable
+	{
+		return do_sort(pool, std::move(lower));
+	});
+	std::list<T> new_higher(do_sort(pool, std::move(chunk_data)));
+
+	result.splice(result.end(), new_higher);
+	result.splice(result.begin(), new_lower.get());
+	return result;
+}
+
+double sort_ms(thread_pool& pool, std::list<int> const& input)
+{
+	clock_type::time_point const start = clock_type::now();
+	std::list<int> const sorted = do_sort(pool, input);
+	clock_type::time_point const stop = clock_type::now();
+	if( !std::is_sorted(sorted.begin(), sorted.end()) )
+	{
+		std::cout << "NOT SORTED" << std::endl;
+	}
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+double empty_tasks_ms(thread_pool& pool, unsigned count)
+{
+	clock_type::time_point const start = clock_type::now();
+	pool.submit_range(0, count, [](std::size_t) {}).get();
+	clock_type::time_point const stop = clock_type::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	std::size_t const length = argc > 1 ? std::atol(argv[1]) : 200000;
+	char const* const path = argc > 2 ? argv[2] : "pool_trace.json";
+
+	std::list<int> input;
+	for( std::size_t i = 0 ; i < length ; i++ )
+	{
+		input.push_back(std::rand());
+	}
+
+	thread_pool pool;
+	double const untraced = sort_ms(pool, input);
+	double const untraced_empty = empty_tasks_ms(pool, 200000);
+
+	pool.start_trace(1 << 20);
+	double const traced_empty = empty_tasks_ms(pool, 200000);
+	pool.stop_trace();
+
+	/* Restart so the file only holds the sort */
+	pool.start_trace();
+	double const traced = sort_ms(pool, input);
+	pool.stop_trace();
+
+	std::ofstream out(path);
+	pool.write_trace(out);
+	std::cout << "sort of " << length << " elements : " << untraced << " ms untraced, " << traced << " ms traced" << std::endl;
+	std::cout << "200000 empty tasks : " << untraced_empty << " ms untraced, " << traced_empty << " ms traced" << std::endl;
+	std::cout << "trace written to " << path << " (" << out.tellp() << " bytes)" << std::endl;
+	return 0;
+}
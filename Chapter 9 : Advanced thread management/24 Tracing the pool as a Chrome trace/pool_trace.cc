@@ -0,0 +1,254 @@
+/*
+ * pool_trace.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The counters in ../15 say how much time the workers spent idle, but not when, or what they were
+waiting for. parallel_quick_sort in ../4 scales poorly, and totals cannot show the reason : the
+first partition runs on one thread while the rest wait, and later every get() waits on the
+slowest half.
+
+pool_trace records a timeline :
+1. Each worker has its own ring buffer of events : task begin and end (and where the task came
+   from : own deque, inbox, stolen, global queue), steals (and from whom), park and unpark. Only
+   that worker writes its buffer, so recording is a handful of plain stores with no lock and no
+   read-modify-write. When the ring is full the oldest events are overwritten. Threads outside the
+   pool that run tasks while they wait share one extra buffer, which reserves slots with fetch_add.
+   Every slot carries the number of the event it holds, cleared while it is being written, so a
+   reader can tell a finished event from a half-written or overwritten one (a per-slot seqlock).
+2. Timestamps come from steady_clock (now_ns() in ../15), not the TSC, so they are comparable
+   across cores on any machine.
+3. write_chrome_trace() dumps the events recorded since start() as Chrome trace-event JSON.
+   Open it in chrome://tracing or https://ui.perfetto.dev : one track per worker, tasks as slices,
+   parked time as "parked" slices and steals as instant events. It can be called while the pool
+   runs; events overwritten during the dump are skipped.
+4. Buffers are allocated by the first start(). Until then, and after stop(), each place that
+   would record costs one load of the enabled flag and a predictable branch.
+ */
+#ifndef POOL_TRACE_CC
+#define POOL_TRACE_CC
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include "../15 Per-worker pool metrics/pool_metrics.cc"
+
+enum class trace_kind : std::uint8_t
+{
+	task_begin,			// arg : task_source
+	task_end,
+	steal,				// arg : index of the victim worker
+	park,
+	unpark
+};
+
+enum class task_source : std::uint8_t
+{
+	own_deque,
+	inbox,
+	stolen,
+	global_queue
+};
+
+/* One thread's ring of events, or the shared one for threads outside the pool */
+class trace_buffer
+{
+	struct slot
+	{
+		std::atomic<std::uint64_t> sequence;	// event number + 1 once written, 0 while being written
+		std::atomic<std::uint64_t> ts_ns;
+		std::atomic<std::uint64_t> what;		// kind in the low byte, arg above it
+	};
+
+	bool shared;
+	std::size_t mask;
+	std::unique_ptr<slot[]> slots;
+	std::atomic<std::uint64_t> head;		// events ever recorded, or in the shared buffer reserved
+
+public:
+	trace_buffer() : shared(false), mask(0), head(0)
+	{}
+
+	void init(std::size_t capacity, bool shared_)
+	{
+		std::size_t size = 2;
+		while( size < capacity )
+		{
+			size <<= 1;
+		}
+		shared = shared_;
+		mask = size - 1;
+		slots.reset(new slot[size]);
+		for( std::size_t i = 0 ; i < size ; i++ )
+		{
+			slots[i].sequence.store(0, std::memory_order_relaxed);
+			slots[i].ts_ns.store(0, std::memory_order_relaxed);
+			slots[i].what.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void record(trace_kind kind, std::uint32_t arg, std::uint64_t ts_ns)
+	{
+		std::uint64_t const h = shared ? head.fetch_add(1, std::memory_order_relaxed) : head.load(std::memory_order_relaxed);
+		slot& s = slots[h & mask];
+
+		/* A reader that sees any of the new contents also sees the slot marked as being written */
+		s.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		s.ts_ns.store(ts_ns, std::memory_order_relaxed);
+		s.what.store(static_cast<std::uint64_t>(kind) | (static_cast<std::uint64_t>(arg) << 8), std::memory_order_relaxed);
+		s.sequence.store(h + 1, std::memory_order_release);
+		if( !shared )
+		{
+			head.store(h + 1, std::memory_order_release);
+		}
+	}
+
+	/* f(ts_ns, kind, arg) for every event still in the ring, oldest first */
+	template<typename Function>
+	void for_each(Function f) const
+	{
+		std::uint64_t const capacity = mask + 1;
+		std::uint64_t const end = head.load(std::memory_order_acquire);
+		std::uint64_t const begin = end > capacity ? end - capacity : 0;
+		for( std::uint64_t i = begin ; i < end ; i++ )
+		{
+			/* Not written yet (a reserved slot of the shared buffer), being rewritten, or already reused */
+			slot const& s = slots[i & mask];
+			if( s.sequence.load(std::memory_order_acquire) != i + 1 )
+			{
+				continue;
+			}
+			std::uint64_t const ts = s.ts_ns.load(std::memory_order_relaxed);
+			std::uint64_t const what = s.what.load(std::memory_order_relaxed);
+
+			/* The writer may have lapped us while we read, drop what it overwrote */
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if( s.sequence.load(std::memory_order_relaxed) != i + 1 )
+			{
+				continue;
+			}
+			f(ts, static_cast<trace_kind>(what & 0xff), static_cast<std::uint32_t>(what >> 8));
+		}
+	}
+};
+
+class pool_trace
+{
+	unsigned const buffer_count;				// one per worker, plus the shared one last
+	std::atomic<bool> enabled;
+	std::atomic<std::uint64_t> started_ns;
+	std::unique_ptr<trace_buffer[]> buffers;	// set once, before enabled is first set
+	std::mutex start_mutex;
+
+	static char const* source_name(std::uint32_t source)
+	{
+		switch( static_cast<task_source>(source) )
+		{
+			case task_source::own_deque : return "own deque";
+			case task_source::inbox : return "inbox";
+			case task_source::stolen : return "stolen";
+			default : return "global queue";
+		}
+	}
+
+	/* ns as microseconds with three decimals, without touching the stream's formatting flags */
+	static void write_microseconds(std::ostream& out, std::uint64_t ns)
+	{
+		char const fraction[] = { '.', char('0' + ns / 100 % 10), char('0' + ns / 10 % 10), char('0' + ns % 10), 0 };
+		out << ns / 1000 << fraction;
+	}
+
+public:
+	explicit pool_trace(unsigned worker_count) :
+		buffer_count(worker_count + 1), enabled(false), started_ns(0)
+	{}
+
+	bool on() const
+	{
+		return enabled.load(std::memory_order_acquire);
+	}
+
+	/* Only after on() returned true. buffer is the worker index, or worker_count for other threads */
+	void record(unsigned buffer, trace_kind kind, std::uint32_t arg = 0)
+	{
+		buffers[buffer].record(kind, arg, now_ns());
+	}
+
+	/* events_per_thread only counts the first time, the buffers are kept after that */
+	void start(std::size_t events_per_thread)
+	{
+		std::lock_guard<std::mutex> lk(start_mutex);
+		if( !buffers )
+		{
+			buffers.reset(new trace_buffer[buffer_count]);
+			for( unsigned i = 0 ; i < buffer_count ; i++ )
+			{
+				buffers[i].init(events_per_thread, i == buffer_count - 1);
+			}
+		}
+		started_ns.store(now_ns(), std::memory_order_relaxed);
+		enabled.store(true, std::memory_order_release);
+	}
+
+	void stop()
+	{
+		enabled.store(false, std::memory_order_relaxed);
+	}
+
+	/* Chrome trace-event format, timestamps in microseconds since start() */
+	void write_chrome_trace(std::ostream& out)
+	{
+		std::lock_guard<std::mutex> lk(start_mutex);
+		std::uint64_t const origin = started_ns.load(std::memory_order_relaxed);
+		bool first = true;
+		out << "{\"traceEvents\":[";
+		for( unsigned t = 0 ; buffers && t < buffer_count ; t++ )
+		{
+			out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+				<< ",\"args\":{\"name\":\"" << (t + 1 < buffer_count ? "worker " : "other threads");
+			if( t + 1 < buffer_count )
+			{
+				out << t;
+			}
+			out << "\"}}";
+			first = false;
+
+			buffers[t].for_each([&out, origin, t](std::uint64_t ts, trace_kind kind, std::uint32_t arg)
+			{
+				if( ts < origin )
+				{
+					return;
+				}
+				out << ",\n{\"pid\":1,\"tid\":" << t << ",\"ts\":";
+				write_microseconds(out, ts - origin);
+				out << ',';
+				switch( kind )
+				{
+					case trace_kind::task_begin :
+						out << "\"name\":\"task\",\"ph\":\"B\",\"args\":{\"from\":\"" << source_name(arg) << "\"}}";
+						break;
+					case trace_kind::task_end :
+						out << "\"name\":\"task\",\"ph\":\"E\"}";
+						break;
+					case trace_kind::steal :
+						out << "\"name\":\"steal\",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"victim\":" << arg << "}}";
+						break;
+					case trace_kind::park :
+						out << "\"name\":\"parked\",\"ph\":\"B\"}";
+						break;
+					case trace_kind::unpark :
+						out << "\"name\":\"parked\",\"ph\":\"E\"}";
+						break;
+				}
+			});
+		}
+		out << "\n]}\n";
+	}
+};
+
+#endif /* POOL_TRACE_CC */
@@ -0,0 +1,154 @@
+/*
+ * bounded_pool.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The pools in this chapter accept any amount of work. A producer that submits faster than the
+workers run keeps queueing function_wrappers and task states until memory runs out, and nothing
+tells it to slow down.
+
+bounded_pool puts a capacity in front of a thread_pool (../6). It counts tasks that have been
+submitted through it and not started yet. The count goes down when a worker picks a task up, not
+when the task finishes, so it bounds the queues and not the running tasks. When the count is at
+capacity there are three ways to submit :
+1. submit() blocks until there is room, so the producer runs at the rate the pool drains.
+   A blocked producer parks on an eventcount (../7) and is woken once the backlog is down to half
+   the capacity, not after every task. It then refills in a burst instead of waking for each slot.
+2. try_submit() returns an empty std::optional at once, for callers that would rather shed load
+   or retry later.
+3. submit_or_run_inline() runs the task on the calling thread and returns a handle that is already
+   ready (caller runs). The producer is busy doing a task instead of producing more, which throttles
+   it without blocking.
+A worker that blocks in submit() could wait for a backlog that only it can drain, so from a pool
+thread submit() runs the task inline instead of blocking.
+Tasks submitted to the underlying pool directly are not counted.
+ */
+#ifndef BOUNDED_POOL_CC
+#define BOUNDED_POOL_CC
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+class bounded_pool
+{
+	thread_pool& pool;
+	std::size_t const capacity_;
+	std::size_t const resume_at;					// blocked producers are woken at this backlog
+	std::atomic<std::size_t> queued_count;			// submitted through us, not started yet
+	eventcount space_available;
+
+	bool try_acquire()
+	{
+		std::size_t n = queued_count.load(std::memory_order_relaxed);
+		while( n < capacity_ )
+		{
+			if( queued_count.compare_exchange_weak(n, n + 1, std::memory_order_relaxed) )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* Called by the worker as the task starts. Wakes producers only when the backlog crosses resume_at */
+	void release_slot()
+	{
+		if( queued_count.fetch_sub(1, std::memory_order_relaxed) == resume_at + 1 )
+		{
+			space_available.notify_all();
+		}
+	}
+
+	/* The slot is ours : queue f behind a wrapper that gives it back when f starts, or now if queueing throws */
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit_acquired(FunctionType& f)
+	{
+		try
+		{
+			return pool.submit([this, f = std::move(f)]() mutable
+			{
+				release_slot();
+				return f();
+			});
+		}
+		catch(...)
+		{
+			release_slot();
+			throw;
+		}
+	}
+
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> run_inline(FunctionType f)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		task_body<FunctionType, result_type>(std::move(f), state)();
+		return task_handle<result_type>(state, &pool);
+	}
+
+public:
+	/* pool must outlive us, and we must outlive every task submitted through us */
+	bounded_pool(thread_pool& pool_, std::size_t capacity) :
+		pool(pool_), capacity_(std::max<std::size_t>(capacity, 1)), resume_at(capacity_ / 2), queued_count(0)
+	{}
+
+	bounded_pool(const bounded_pool&) = delete;
+	bounded_pool& operator = (const bounded_pool&) = delete;
+
+	/* Block while the pool is full. From a pool thread, run f inline instead */
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(FunctionType f)
+	{
+		while( !try_acquire() )
+		{
+			if( pool.is_pool_thread() )
+			{
+				return run_inline(std::move(f));
+			}
+			space_available.wait([this] { return queued_count.load(std::memory_order_relaxed) <= resume_at; });
+		}
+		return submit_acquired(f);
+	}
+
+	/* Empty if the pool is full, f has not run and is destroyed */
+	template<typename FunctionType>
+	std::optional<task_handle<typename std::result_of<FunctionType()>::type>> try_submit(FunctionType f)
+	{
+		if( !try_acquire() )
+		{
+			return std::nullopt;
+		}
+		return submit_acquired(f);
+	}
+
+	/* If the pool is full, run f now on this thread. The handle is ready when this returns */
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit_or_run_inline(FunctionType f)
+	{
+		if( !try_acquire() )
+		{
+			return run_inline(std::move(f));
+		}
+		return submit_acquired(f);
+	}
+
+	std::size_t capacity() const
+	{
+		return capacity_;
+	}
+
+	/* Submitted through us and not started yet. Approximate while other threads submit */
+	std::size_t queued() const
+	{
+		return queued_count.load(std::memory_order_relaxed);
+	}
+};
+
+#endif /* BOUNDED_POOL_CC */
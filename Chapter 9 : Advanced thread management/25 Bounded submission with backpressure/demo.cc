@@ -0,0 +1,138 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * A producer that submits 2 million tasks of about 1 us each, much faster than the pool can run
+ * them, in four ways :
+ * 1. straight to thread_pool::submit(), unbounded,
+ * 2. bounded_pool::submit() with a capacity of 1024, blocking while full,
+ * 3. bounded_pool::try_submit(), dropping the tasks that do not fit,
+ * 4. bounded_pool::submit_or_run_inline(), the producer running the tasks that do not fit.
+ * Each way runs in its own child process so that its peak resident memory can be read from
+ * getrusage(). It prints the time until every accepted task has run, the peak RSS, and how
+ * many tasks were dropped or run inline.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bounded_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+enum class mode
+{
+	unbounded,
+	blocking,
+	try_submit,
+	caller_runs
+};
+
+/* About 1 us of arithmetic the compiler cannot drop */
+unsigned long work(unsigned long seed)
+{
+	for( unsigned i = 0 ; i < 300 ; i++ )
+	{
+		seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+	}
+	return seed;
+}
+
+void produce(mode how, unsigned long count, std::size_t capacity)
+{
+	thread_pool pool;
+	bounded_pool bounded(pool, capacity);
+	std::atomic<unsigned long> ran(0);
+	std::atomic<unsigned long> sink(0);
+	unsigned long accepted = 0;
+	unsigned long dropped = 0;
+	unsigned long inline_runs = 0;
+
+	clock_type::time_point const start = clock_type::now();
+	for( unsigned long i = 0 ; i < count ; i++ )
+	{
+		auto task = [&ran, &sink, i]
+		{
+			sink.fetch_add(work(i) & 1, std::memory_order_relaxed);
+			ran.fetch_add(1, std::memory_order_relaxed);
+		};
+		switch( how )
+		{
+			case mode::unbounded :
+				pool.submit(task);
+				accepted++;
+				break;
+			case mode::blocking :
+				bounded.submit(task);
+				accepted++;
+				break;
+			case mode::try_submit :
+				if( bounded.try_submit(task) )
+				{
+					accepted++;
+				}
+				else
+				{
+					dropped++;
+				}
+				break;
+			case mode::caller_runs :
+				if( bounded.submit_or_run_inline(task).is_ready() )
+				{
+					inline_runs++;		// may also count a queued task that already finished
+				}
+				accepted++;
+				break;
+		}
+	}
+	while( ran.load(std::memory_order_relaxed) < accepted )
+	{
+		std::this_thread::yield();
+	}
+	clock_type::time_point const stop = clock_type::now();
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	static char const* const names[] = { "unbounded submit()", "blocking submit()", "try_submit()", "submit_or_run_inline()" };
+	std::cout << names[static_cast<int>(how)] << " : " << std::chrono::duration<double, std::milli>(stop - start).count()
+			  << " ms, peak RSS " << usage.ru_maxrss / 1024 << " MB";
+	if( how == mode::try_submit )
+	{
+		std::cout << ", " << dropped << " dropped";
+	}
+	if( how == mode::caller_runs )
+	{
+		std::cout << ", about " << inline_runs << " run inline";
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const count = argc > 1 ? std::atol(argv[1]) : 2000000;
+	std::size_t const capacity = argc > 2 ? std::atol(argv[2]) : 1024;
+	std::cout << count << " tasks, capacity " << capacity << ", " << std::thread::hardware_concurrency() << " cores" << std::endl;
+
+	mode const modes[] = { mode::unbounded, mode::blocking, mode::try_submit, mode::caller_runs };
+	for( mode how : modes )
+	{
+		/* A fresh process per mode, ru_maxrss never goes down */
+		pid_t const child = fork();
+		if( child == 0 )
+		{
+			produce(how, count, capacity);
+			std::_Exit(0);
+		}
+		waitpid(child, nullptr, 0);
+	}
+	return 0;
+}
@@ -14,6 +14,8 @@
 #include <thread>
 #include <type_traits>
 #include <vector>
+#include "../7 Parking idle workers with an eventcount/eventcount.cc"
+#include "../8 A function_wrapper without heap allocation/function_wrapper.cc"
 
 
 /* Implementation in other chapter */
@@ -23,59 +25,11 @@ struct join_threads
     {}
 };
 
-class function_wrapper
-{
-	struct impl_base
-	{
-		virtual void call() = 0;
-		virtual ~impl_base() {}
-	};
-
-	std::unique_ptr<impl_base> impl;
-	template<typename F>
-	struct impl_type : impl_base
-	{
-		F f;
-		impl_type(F&& f_) : f(std::move(f_)) {}
-		void call()
-		{
-			f();
-		}
-	};
-
-public:
-
-	template<typename F>
-	function_wrapper(F&& f ) : impl(new impl_type<F>(std::move(f)))
-	{}
-
-	/* Overload () operator */
-	void operator () ()
-	{
-		impl->call();
-	}
-
-	function_wrapper() = default;
-
-	function_wrapper(function_wrapper&& other) : impl(std::move(other.impl))
-	{}
-
-	function_wrapper& operator = (function_wrapper&& other)
-	{
-		impl = std::move(other.impl);
-		return *this;
-	}
-
-	function_wrapper(const function_wrapper&) = delete;
-	function_wrapper(function_wrapper&) = delete;
-	function_wrapper& operator = (const function_wrapper&) = delete;
-};
-
 class thread_pool
 {
 public:
 	/* Constructor */
-	thread_pool() : done(false), joiner(threads)
+	explicit thread_pool(idle_options idle_ = idle_options()) : done(false), idle(idle_), joiner(threads)
 	{
 		// Get hardware concurrency count
 		unsigned const thread_count = std::thread::hardware_concurrency();
@@ -96,6 +50,7 @@ public:
 			 * block that sets the done flag when an exception is thrown.
 			 */
 			done = true;
+			work_available.notify_all();
 			throw;
 		}
 	}
@@ -104,6 +59,7 @@ public:
 	~thread_pool()
 	{
 		done = true;
+		work_available.notify_all();
 	}
 
 	/* Submit a task to work queue
@@ -135,27 +91,36 @@ public:
 		 */
 		std::future<result_type> result(task.get_future());
 		work_queue.push(std::move(task));
+
+		/* Wake a parked worker, only costs a fence and a load when none are parked */
+		work_available.notify_one();
 		return result;
 	}
 
 private:
 	void worker_thread()
 	{
+		idle_backoff backoff(idle);
 		while( !done )
 		{
 			function_wrapper task;
 			if( work_queue.try_pop(task) )
 			{
 				task();
+				backoff.reset();
 			}
-			else
+			else if( !backoff.backoff() )
 			{
-				std::this_thread::yield();
+				/* Nothing found while spinning : park until submit() signals (see ../7) */
+				work_available.wait([this] { return done || !work_queue.empty(); });
+				backoff.reset();
 			}
 		}
 	}
 
 	std::atomic_bool done;
+	idle_options const idle;
+	eventcount work_available;
 	/* NOTE : Used function_wrapper rather than std::function */
 	thread_safe_queue<function_wrapper> work_queue;
 	std::vector<std::thread> threads;
@@ -47,9 +47,13 @@ struct sorter
 		std::list<T> new_higher(do_sort(chunk_data));
 
 		result.splice(result.end(), new_higher);
-		while( !new_lower.wait_for(std::chrono::seconds(0)) == std::future_status::timeout )
+		while( new_lower.wait_for(std::chrono::seconds(0)) == std::future_status::timeout )
 		{
-			pool.run_pending_task();
+			/* Nothing queued : the lower half is running on a worker, block on it briefly instead of spinning */
+			if( !pool.run_pending_task() )
+			{
+				new_lower.wait_for(std::chrono::microseconds(50));
+			}
 		}
 
 		result.splice(result.begin(), new_lower.get());
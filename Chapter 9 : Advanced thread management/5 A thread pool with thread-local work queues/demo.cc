@@ -13,11 +13,16 @@
 #include <queue>
 #include <thread>
 #include <type_traits>
+#include "../7 Parking idle workers with an eventcount/eventcount.cc"
 
 class thread_pool
 {
 	thread_safe_queue<funtion_wrapper> pool_work_queue;
 
+	/* Idle workers park here, see ../7 */
+	idle_options const idle;
+	eventcount work_available;
+
 	/* local queue can be a plain std::queue<> because it's only ever accessed by one thread */
 	typedef std::queue<function_wrapper> local_queue_type;
 
@@ -31,9 +36,22 @@ class thread_pool
 		// Local thread queue is initialized before processing step
 		local_work_queue.reset(new local_queue_type);
 
+		idle_backoff backoff(idle);
 		while( !done )
 		{
-			run_pending_task();
+			if( run_pending_task() )
+			{
+				backoff.reset();
+			}
+			else if( !backoff.backoff() )
+			{
+				/*
+				 * Our local queue is empty (only we fill it), so the only work that can turn up is on
+				 * pool_work_queue : park until submit() signals
+				 */
+				work_available.wait([this] { return done || !pool_work_queue.empty(); });
+				backoff.reset();
+			}
 		}
 	}
 
@@ -51,12 +69,16 @@ public:
 		else
 		{
 			pool_work_queue.push(std::move(task));
+
+			/* Only the global queue can wake a parked worker, local tasks are run by their owner */
+			work_available.notify_one();
 		}
 
 		return result;
 	}
 
-	void run_pending_task()
+	/* Returns false if there was nothing to run, the caller decides whether to spin or park */
+	bool run_pending_task()
 	{
 		function_wrapper task;
 
@@ -69,6 +91,7 @@ public:
 			task = std::move(local_work_queue->front());
 			local_work_queue->pop();
 			task();
+			return true;
 		}
 		else if( pool_work_queue.try_pop(task))
 		{
@@ -76,14 +99,13 @@ public:
 			 * If there are no tasks on the local queue, you try the pool queue as before
 			 */
 			task();
+			return true;
 		}
-		else
-		{
-			std::this_thread::yield();
-		}
+		return false;
 	}
 
-	// NOTE : rest as before thread pool implementation
+	// NOTE : rest as before thread pool implementation, constructor takes idle_options and the
+	// destructor calls work_available.notify_all() after setting done
 };
 
 
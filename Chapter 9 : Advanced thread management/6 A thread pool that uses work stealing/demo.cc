@@ -0,0 +1,101 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Quicksort from ../4 running on the work-stealing pool. Each do_sort() pushes the lower chunk onto
+ * the calling worker's own deque, idle workers steal the oldest (largest) chunks, and the waiting
+ * worker keeps running pending tasks instead of blocking.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <list>
+#include "thread_pool.cc"
+
+template<typename T>
+struct sorter
+{
+	thread_pool pool;
+
+	std::list<T> do_sort(std::list<T>& chunk_data)
+	{
+		if( chunk_data.empty() )
+		{
+			return chunk_data;
+		}
+
+		std::list<T> result;
+		result.splice(result.begin(), chunk_data, chunk_data.begin());
+		T const& partition_val = *result.begin();
+
+		typename std::list<T>::iterator divide_point = std::partition(chunk_data.begin(),
+																		chunk_data.end(),
+																		[&](T const& val)
+																		{
+																			return val<partition_val;
+																		});
+		std::list<T> new_lower_chunk;
+		new_lower_chunk.splice(new_lower_chunk.end(), chunk_data, chunk_data.begin(), divide_point);
+
+		task_handle<std::list<T>> new_lower = pool.submit(std::bind(&sorter::do_sort,
+																	this,
+																	std::move(new_lower_chunk)));
+
+		std::list<T> new_higher(do_sort(chunk_data));
+		result.splice(result.end(), new_higher);
+
+		/*
+		 * get() helps out while the lower half is pending : our own deque first, so we usually pop it
+		 * straight back. If there is nothing to run, the lower half is running on another worker and
+		 * get() sleeps until it is done.
+		 */
+		result.splice(result.begin(), new_lower.get());
+		return result;
+	}
+};
+
+template<typename T>
+std::list<T> parallel_quick_sort(std::list<T> input)
+{
+	if( input.empty() )
+	{
+		return input;
+	}
+
+	/*
+	 * Run the top level on a pool thread too. do_sort() then always pushes onto a worker's own deque and
+	 * pops its own lower half straight back, so helping while waiting nests no deeper than the recursion.
+	 * A non-pool caller would push every lower half onto the global queue and pick up the oldest one
+	 * while waiting, nesting unrelated sorts on its stack.
+	 */
+	sorter<T> s;
+	return s.pool.submit([&s, &input] { return s.do_sort(input); }).get();
+}
+
+int main(int argc, char **argv)
+{
+	unsigned const count = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+	std::list<int> input;
+	std::srand(42);
+	for( unsigned i = 0 ; i < count ; i++ )
+	{
+		input.push_back(std::rand());
+	}
+
+	auto const start = std::chrono::steady_clock::now();
+	std::list<int> sorted = parallel_quick_sort(input);
+	auto const stop = std::chrono::steady_clock::now();
+
+	std::cout << "sorted " << sorted.size() << " elements in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms, "
+			  << (std::is_sorted(sorted.begin(), sorted.end()) ? "ok" : "NOT SORTED") << std::endl;
+	return 0;
+}
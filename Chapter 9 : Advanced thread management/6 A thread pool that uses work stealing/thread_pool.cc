@@ -0,0 +1,861 @@
+/*
+ * thread_pool.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *      Pg 287 (listing 9.8)
+ *
+In ../5 each worker has a plain std::queue<> that no other thread can reach. If one worker's
+recursive tasks pile up on its local queue, the other workers can only spin on
+pool_work_queue while work sits waiting behind a busy thread.
+
+Here every worker owns a work_stealing_queue:
+1. Tasks submitted from a pool thread go onto that thread's own queue, without any lock.
+2. A worker looks for work in this order : its own queue (LIFO), the queues of other workers
+   (FIFO steal, starting at a randomly chosen victim), and finally the global pool_work_queue.
+3. The global queue is now only used for tasks submitted from outside the pool, so it is off
+   the hot path of recursive algorithms. It is a lock-free mpmc_queue (see ../22).
+4. A worker that finds nothing spins, yields and then parks on an eventcount (see ../7).
+5. submit_bulk() and submit_range() enqueue a batch 256 tasks at a time, with one wake-up per chunk
+   (see ../9).
+6. submit() returns a task_handle<> instead of a std::future<>, and deque nodes and task states
+   come from a per-thread slab_allocator (see ../10). Continuations attached with then() are
+   queued through schedule() (see ../14).
+7. With worker_placement::pinned each worker is pinned to its own cpu and steals from its nearest
+   neighbours first : SMT sibling, shared L2, shared L3, same socket, remote (see ../12).
+8. Every worker keeps its own counters, and stats() merges them into a snapshot (see ../15).
+9. submit() and post() take an optional std::stop_token; once stop is requested, queued tasks are
+   dropped instead of run (see ../17).
+10. co_await pool.schedule() moves a coroutine onto the pool, and co_await on a task_handle<>
+   resumes it there once the task is done (see ../18).
+11. wants_more_work() tells a parallel loop whether splitting its range would feed an idle thief
+   (see ../19).
+12. submit_to(worker, f) and submit_affine(key, f) run f on one particular worker, through an inbox
+   that only that worker pops and nobody steals from (see ../21).
+13. start_trace() records task, steal and park events per worker until stop_trace(), and
+   write_trace() dumps them as a Chrome trace (see ../24).
+ */
+#ifndef THREAD_POOL_CC
+#define THREAD_POOL_CC
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "work_stealing_queue.cc"
+#include "../7 Parking idle workers with an eventcount/eventcount.cc"
+#include "../8 A function_wrapper without heap allocation/function_wrapper.cc"
+#include "../10 Pool-native task handles/task_handle.cc"
+#include "../12 Pinning workers to the cpu topology/cpu_topology.cc"
+#include "../15 Per-worker pool metrics/pool_metrics.cc"
+#include "../17 Cooperative cancellation with stop tokens/stoppable_task.cc"
+#include "../18 Coroutines on the thread pool/pool_coroutines.cc"
+#include "../22 A lock-free global queue/mpmc_queue.cc"
+#include "../24 Tracing the pool as a Chrome trace/pool_trace.cc"
+
+class join_threads
+{
+	std::vector<std::thread>& threads;
+public:
+	explicit join_threads(std::vector<std::thread>& threads_) : threads(threads_)
+	{}
+
+	~join_threads()
+	{
+		for(unsigned long i = 0 ; i < threads.size() ; i++ )
+		{
+			if( threads[i].joinable() )
+			{
+				threads[i].join();
+			}
+		}
+	}
+};
+
+/* Copy of : Chapter 4/2 Thread safe queue using condition variables, only the parts the pool needs */
+template<typename T>
+class thread_safe_queue
+{
+	mutable std::mutex mut;
+	std::queue<T> data_queue;
+public:
+	void push(T new_value)
+	{
+		std::lock_guard<std::mutex> lk(mut);
+		data_queue.push(std::move(new_value));
+	}
+
+	/* Move every element of [first, last) in under a single lock */
+	template<typename Iterator>
+	void push_range(Iterator first, Iterator last)
+	{
+		std::lock_guard<std::mutex> lk(mut);
+		for( ; first != last ; ++first )
+		{
+			data_queue.push(std::move(*first));
+		}
+	}
+
+	bool try_pop(T& value)
+	{
+		std::lock_guard<std::mutex> lk(mut);
+		if( data_queue.empty() )
+		{
+			return false;
+		}
+		value = std::move(data_queue.front());
+		data_queue.pop();
+		return true;
+	}
+
+	bool empty() const
+	{
+		std::lock_guard<std::mutex> lk(mut);
+		return data_queue.empty();
+	}
+
+	std::size_t size() const
+	{
+		std::lock_guard<std::mutex> lk(mut);
+		return data_queue.size();
+	}
+};
+
+enum class worker_placement
+{
+	unpinned,		// let the OS schedule the workers, steal from random victims
+	pinned			// one cpu per worker, steal nearest first
+};
+
+class thread_pool : public pending_task_runner
+{
+	typedef function_wrapper task_type;
+
+	/* What the queues hold : the task, and when it was queued if we are timing */
+	struct queued_task
+	{
+		task_type task;
+		std::uint64_t enqueued_ns;
+
+		queued_task() : enqueued_ns(0)
+		{}
+
+		queued_task(task_type&& task_, std::uint64_t enqueued_ns_) : task(std::move(task_)), enqueued_ns(enqueued_ns_)
+		{}
+	};
+
+	typedef work_stealing_queue<queued_task, slab_deleter> local_queue_type;
+
+	/* NOTE : Order of declaration matters, the queues must outlive the threads (see ../1) */
+	std::atomic_bool done;
+	idle_options const idle;
+	metrics_level const metrics_mode;
+	std::unique_ptr<worker_metrics[]> metrics;		// one per worker, plus one for other threads
+	pool_trace trace;								// the same layout, off until start_trace()
+	eventcount work_available;
+	mpmc_queue<queued_task> pool_work_queue;
+	std::vector<std::unique_ptr<local_queue_type>> queues;
+	std::vector<std::unique_ptr<thread_safe_queue<queued_task>>> inboxes;		// affine tasks, one per worker
+
+	/*
+	 * steal_order[i] lists the other workers' indices for worker i, in groups of equal distance, nearest
+	 * group first. Unpinned it is a single group. external_steal_order is used by non pool threads.
+	 */
+	typedef std::vector<std::vector<unsigned>> victim_groups;
+	std::vector<victim_groups> steal_order;
+	victim_groups external_steal_order;
+	std::vector<unsigned> worker_cpu;		// empty when unpinned
+	std::vector<std::thread> threads;
+	join_threads joiner;
+
+	/* Queue owned by the current thread and its index in queues, nullptr for non pool threads */
+	static thread_local local_queue_type* local_work_queue;
+	static thread_local unsigned my_index;
+
+	/* Timing only : when this worker ran out of work (0 if it has not), and how deep in nested tasks it is */
+	static thread_local std::uint64_t idle_since;
+	static thread_local unsigned run_depth;
+
+	void worker_thread(unsigned my_index_)
+	{
+		my_index = my_index_;
+		local_work_queue = queues[my_index].get();
+		if( !worker_cpu.empty() )
+		{
+			cpu_topology::pin_current_thread(worker_cpu[my_index]);
+		}
+
+		idle_backoff backoff(idle);
+		while( !done )
+		{
+			if( run_pending_task() )
+			{
+				backoff.reset();
+				continue;
+			}
+
+			/* run_counted() adds the time up to the next task to idle_ns */
+			if( !idle_since && metrics_mode == metrics_level::timing )
+			{
+				idle_since = now_ns();
+			}
+			if( !backoff.backoff() )
+			{
+				bool const tracing = trace.on();
+				if( tracing )
+				{
+					trace.record(my_index, trace_kind::park);
+				}
+				work_available.wait([this] { return done || has_pending_work() || !inboxes[my_index]->empty(); });
+				if( tracing )
+				{
+					trace.record(my_index, trace_kind::unpark);
+				}
+				backoff.reset();
+			}
+		}
+		local_work_queue = nullptr;
+	}
+
+	std::uint64_t enqueue_time() const
+	{
+		return metrics_mode == metrics_level::timing ? now_ns() : 0;
+	}
+
+	void enqueue(task_type task)
+	{
+		/* From a pool thread, push onto our own deque without taking any lock */
+		if( is_pool_thread() )
+		{
+			local_work_queue->push(local_queue_type::item_ptr(slab_new<queued_task>(std::move(task), enqueue_time())));
+		}
+		else
+		{
+			pool_work_queue.push(queued_task(std::move(task), enqueue_time()));
+		}
+
+		/* Wake a parked worker so it can steal the new task, free if nobody is parked */
+		work_available.notify_one();
+	}
+
+	/*
+	 * Bulk submissions are queued bulk_chunk tasks at a time, so the batch is built in a small buffer
+	 * that is reused rather than in one vector as long as the batch, and the workers can start on the
+	 * first chunk while the rest is being built.
+	 */
+	static constexpr std::size_t bulk_chunk = 256;
+
+	/*
+	 * Only the owner may push onto a work_stealing_queue, so a batch cannot be dealt straight onto other
+	 * workers' deques. It goes onto ours (or the global queue) in one go and every parked worker is woken
+	 * to steal its share. Leaves tasks empty.
+	 */
+	void enqueue_bulk(std::vector<queued_task>& tasks)
+	{
+		if( tasks.empty() )
+		{
+			return;
+		}
+
+		if( is_pool_thread() )
+		{
+			for( unsigned long i = 0 ; i < tasks.size() ; i++ )
+			{
+				local_work_queue->push(local_queue_type::item_ptr(slab_new<queued_task>(std::move(tasks[i]))));
+			}
+		}
+		else
+		{
+			pool_work_queue.push_range(tasks.begin(), tasks.end());
+		}
+
+		if( tasks.size() == 1 )
+		{
+			work_available.notify_one();
+		}
+		else
+		{
+			work_available.notify_all();
+		}
+		tasks.clear();
+	}
+
+	/* Room for the whole batch up front when we can count it without consuming it */
+	template<typename Iterator, typename Vector>
+	static void reserve_for(Iterator first, Iterator last, Vector& v, std::forward_iterator_tag)
+	{
+		v.reserve(std::distance(first, last));
+	}
+
+	template<typename Iterator, typename Vector>
+	static void reserve_for(Iterator, Iterator, Vector&, std::input_iterator_tag)
+	{}
+
+	/* Any queue, ours or someone else's, has something we could run */
+	bool has_pending_work() const
+	{
+		if( !pool_work_queue.empty() )
+		{
+			return true;
+		}
+		for( unsigned i = 0 ; i < queues.size() ; i++ )
+		{
+			if( !queues[i]->empty() )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool pop_task_from_local_queue(queued_task& task)
+	{
+		if( !is_pool_thread() )
+		{
+			return false;
+		}
+		local_queue_type::item_ptr item = local_work_queue->try_pop();
+		if( !item )
+		{
+			return false;
+		}
+		task = std::move(*item);
+		return true;
+	}
+
+	bool pop_task_from_inbox(queued_task& task)
+	{
+		return is_pool_thread() && inboxes[my_index]->try_pop(task);
+	}
+
+	/*
+	 * Only the target may pop its inbox, and notify_one() could wake some other worker that would
+	 * go straight back to sleep, so wake them all. Costs nothing if nobody is parked.
+	 */
+	void enqueue_to(unsigned worker, task_type task)
+	{
+		worker %= static_cast<unsigned>(queues.size());
+		inboxes[worker]->push(queued_task(std::move(task), enqueue_time()));
+		if( !is_pool_thread() || my_index != worker )
+		{
+			work_available.notify_all();
+		}
+	}
+
+	/* Spread the key's bits so that keys differing only in their low bits still land apart */
+	unsigned worker_for_key(std::size_t hash) const
+	{
+		std::uint64_t const mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+		return static_cast<unsigned>((mixed >> 32) % queues.size());
+	}
+
+	bool pop_task_from_pool_queue(queued_task& task)
+	{
+		return pool_work_queue.try_pop(task);
+	}
+
+	/* Cheap per-thread xorshift, std::mt19937 is far too big to keep per steal attempt */
+	static unsigned next_random()
+	{
+		static thread_local unsigned state = static_cast<unsigned>(
+				std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	/*
+	 * Walk the victim groups nearest first. Within a group start at a random victim so that idle
+	 * workers do not all hammer the same queue.
+	 */
+	bool pop_task_from_other_thread_queue(queued_task& task)
+	{
+		victim_groups const& groups = is_pool_thread() ? steal_order[my_index] : external_steal_order;
+		for( unsigned g = 0 ; g < groups.size() ; g++ )
+		{
+			std::vector<unsigned> const& victims = groups[g];
+			unsigned const count = static_cast<unsigned>(victims.size());
+			unsigned const start = next_random() % count;
+
+			for( unsigned i = 0 ; i < count ; i++ )
+			{
+				unsigned const victim = victims[(start + i) % count];
+				local_queue_type::item_ptr item = queues[victim]->try_steal();
+				if( item )
+				{
+					if( trace.on() )
+					{
+						trace.record(trace_index(), trace_kind::steal, victim);
+					}
+					task = std::move(*item);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	unsigned trace_index() const
+	{
+		return is_pool_thread() ? my_index : static_cast<unsigned>(queues.size());
+	}
+
+	worker_metrics& my_metrics()
+	{
+		return is_pool_thread() ? metrics[my_index] : metrics[queues.size()];
+	}
+
+	void run_task(queued_task& item, worker_metrics& m, task_source from)
+	{
+		bool const tracing = trace.on();
+		if( tracing )
+		{
+			trace.record(trace_index(), trace_kind::task_begin, static_cast<std::uint32_t>(from));
+		}
+		run_counted(item, m);
+		if( tracing )
+		{
+			trace.record(trace_index(), trace_kind::task_end);
+		}
+	}
+
+	/*
+	 * Counted as executed when it starts, so a stats() call right after get() returns sees the task.
+	 * Its run time is only recorded once it has finished.
+	 */
+	void run_counted(queued_task& item, worker_metrics& m)
+	{
+		m.add(m.tasks_executed);
+		if( (m.tasks_executed.load(std::memory_order_relaxed) & 63) == 0 )
+		{
+			if( is_pool_thread() )
+			{
+				m.record(m.local_depth, local_work_queue->size());
+			}
+			m.record(m.pool_depth, pool_work_queue.size());
+		}
+
+		if( metrics_mode == metrics_level::timing )
+		{
+			std::uint64_t const start = now_ns();
+			if( idle_since )
+			{
+				m.add(m.idle_ns, start - idle_since);
+				idle_since = 0;
+			}
+			if( item.enqueued_ns )
+			{
+				m.record(m.sojourn_ns, start - item.enqueued_ns);
+			}
+
+			run_depth++;
+			item.task();
+			run_depth--;
+
+			/* A task that helps while it waits includes the tasks it ran, only count the outermost as busy */
+			std::uint64_t const elapsed = now_ns() - start;
+			m.record(m.run_ns, elapsed);
+			if( !run_depth )
+			{
+				m.add(m.busy_ns, elapsed);
+			}
+		}
+		else
+		{
+			item.task();
+		}
+	}
+
+	/* Group the other workers by topology distance from worker, nearest first. One group if unpinned */
+	victim_groups victims_of(unsigned worker, cpu_topology const* topology) const
+	{
+		victim_groups groups;
+		unsigned const worker_count = static_cast<unsigned>(queues.size());
+		for( unsigned distance = 0 ; distance <= 5 ; distance++ )
+		{
+			std::vector<unsigned> group;
+			for( unsigned other = 0 ; other < worker_count ; other++ )
+			{
+				if( other == worker )
+				{
+					continue;
+				}
+				unsigned const d = topology ? topology->distance(worker_cpu[worker], worker_cpu[other]) : 5;
+				if( d == distance )
+				{
+					group.push_back(other);
+				}
+			}
+			if( !group.empty() )
+			{
+				groups.push_back(group);
+			}
+		}
+		return groups;
+	}
+
+public:
+	explicit thread_pool(unsigned thread_count = std::max(std::thread::hardware_concurrency(), 1u),
+						 idle_options idle_ = idle_options(),
+						 worker_placement placement = worker_placement::unpinned,
+						 metrics_level metrics_mode_ = metrics_level::counters) :
+		done(false), idle(idle_), metrics_mode(metrics_mode_), metrics(new worker_metrics[thread_count + 1]),
+		trace(thread_count), joiner(threads)
+	{
+		metrics[thread_count].shared = true;
+
+		/*
+		 * Create every queue and steal order before starting any thread, thieves index into them
+		 * without a lock
+		 */
+		for( unsigned i = 0 ; i < thread_count ; i++ )
+		{
+			queues.push_back(std::unique_ptr<local_queue_type>(new local_queue_type));
+			inboxes.push_back(std::unique_ptr<thread_safe_queue<queued_task>>(new thread_safe_queue<queued_task>));
+		}
+
+		/* Only read sysfs if we are going to pin */
+		std::unique_ptr<cpu_topology> topology;
+		if( placement == worker_placement::pinned )
+		{
+			topology.reset(new cpu_topology);
+			worker_cpu = topology->worker_cpus(thread_count);
+		}
+		for( unsigned i = 0 ; i < thread_count ; i++ )
+		{
+			steal_order.push_back(victims_of(i, topology.get()));
+		}
+		external_steal_order.push_back(std::vector<unsigned>());
+		for( unsigned i = 0 ; i < thread_count ; i++ )
+		{
+			external_steal_order[0].push_back(i);
+		}
+
+		try
+		{
+			for( unsigned i = 0 ; i < thread_count ; i++ )
+			{
+				threads.push_back(std::thread(&thread_pool::worker_thread, this, i));
+			}
+		}
+		catch(...)
+		{
+			done = true;
+			work_available.notify_all();
+			throw;
+		}
+	}
+
+	~thread_pool()
+	{
+		done = true;
+		work_available.notify_all();
+	}
+
+	/*
+	 * Returns a task_handle<> rather than a std::future<> : its state comes from the slab allocator and
+	 * get() on a pool thread runs other tasks while it waits.
+	 */
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(FunctionType f)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		enqueue(task_type(task_body<FunctionType, result_type>(std::move(f), state)));
+		return task_handle<result_type>(state, this);
+	}
+
+	/* If stop has been requested by the time the task is popped, get() throws task_cancelled */
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit(FunctionType f, std::stop_token token)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		enqueue(task_type(stoppable_task_body<FunctionType, result_type>(std::move(f), state, std::move(token))));
+		return task_handle<result_type>(state, this);
+	}
+
+	/* Fire and forget : no handle and no shared state, for callers that signal completion themselves */
+	template<typename FunctionType>
+	void post(FunctionType f)
+	{
+		enqueue(task_type(std::move(f)));
+	}
+
+	/* Dropped without running if stop has been requested by the time it is popped */
+	template<typename FunctionType>
+	void post(FunctionType f, std::stop_token token)
+	{
+		enqueue(task_type(stoppable_task<FunctionType>(std::move(f), std::move(token))));
+	}
+
+	/*
+	 * Run f on worker_index (modulo worker_count()) and nowhere else, so tasks that touch the same
+	 * data can share one core's caches. A busy or blocked worker delays its affine tasks : they are
+	 * never stolen.
+	 */
+	template<typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit_to(unsigned worker_index, FunctionType f)
+	{
+		typedef typename std::result_of<FunctionType()>::type result_type;
+
+		task_state<result_type>* const state = slab_new<task_state<result_type>>();
+		enqueue_to(worker_index, task_type(task_body<FunctionType, result_type>(std::move(f), state)));
+		return task_handle<result_type>(state, this);
+	}
+
+	/* submit_to() the worker key hashes to. The same key always goes to the same worker of this pool */
+	template<typename Key, typename FunctionType>
+	task_handle<typename std::result_of<FunctionType()>::type> submit_affine(Key const& key, FunctionType f)
+	{
+		return submit_to(worker_for_key(std::hash<Key>()(key)), std::move(f));
+	}
+
+	unsigned worker_count() const
+	{
+		return static_cast<unsigned>(queues.size());
+	}
+
+	/*
+	 * Submit every callable in [first, last) and return one handle per task. From outside the pool the
+	 * batch goes onto pool_work_queue bulk_chunk tasks at a time; from a pool thread it goes onto our
+	 * own deque and idle workers steal it from there.
+	 */
+	template<typename Iterator>
+	std::vector<task_handle<typename std::result_of<typename std::iterator_traits<Iterator>::value_type()>::type>>
+	submit_bulk(Iterator first, Iterator last)
+	{
+		typedef typename std::iterator_traits<Iterator>::value_type function_type;
+		typedef typename std::result_of<function_type()>::type result_type;
+
+		typedef typename std::iterator_traits<Iterator>::iterator_category category;
+
+		std::vector<task_handle<result_type>> results;
+		reserve_for(first, last, results, category());
+		std::vector<queued_task> tasks;
+		tasks.reserve(bulk_chunk);
+		std::uint64_t const now = enqueue_time();
+		for( ; first != last ; ++first )
+		{
+			task_state<result_type>* const state = slab_new<task_state<result_type>>();
+			results.emplace_back(state, this);
+			tasks.emplace_back(task_type(task_body<function_type, result_type>(std::move(*first), state)), now);
+			if( tasks.size() == bulk_chunk )
+			{
+				enqueue_bulk(tasks);
+			}
+		}
+		enqueue_bulk(tasks);
+		return results;
+	}
+
+	/*
+	 * Run f(i) for every i in [first, last), grain indices per task, and return a single handle that
+	 * becomes ready once all of them have run, holding the first exception thrown if any. One shared
+	 * state for the whole range instead of one per task.
+	 */
+	template<typename Function>
+	task_handle<void> submit_range(std::size_t first, std::size_t last, Function f, std::size_t grain = 1)
+	{
+		struct range_state
+		{
+			Function f;
+			task_state<void>* state;
+			std::atomic<std::size_t> remaining;
+			std::atomic<bool> failed;
+			std::exception_ptr error;
+
+			range_state(Function&& f_, task_state<void>* state_, std::size_t count) :
+				f(std::move(f_)), state(state_), remaining(count), failed(false)
+			{}
+
+			/* Last chunk out completes the handle and drops the range's reference */
+			void chunk_done()
+			{
+				if( remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+				{
+					if( error )
+					{
+						state->set_exception(error);
+					}
+					else
+					{
+						state->set_value();
+					}
+					state->release();
+				}
+			}
+		};
+
+		grain = std::max<std::size_t>(grain, 1);
+		std::size_t const count = first < last ? (last - first + grain - 1) / grain : 0;
+		task_state<void>* const state = slab_new<task_state<void>>();
+		task_handle<void> result(state, this);
+		if( !count )
+		{
+			state->set_value();
+			state->release();
+			return result;
+		}
+
+		std::shared_ptr<range_state> range = std::make_shared<range_state>(std::move(f), state, count);
+		std::vector<queued_task> tasks;
+		tasks.reserve(std::min(count, bulk_chunk));
+		std::uint64_t const now = enqueue_time();
+		for( std::size_t begin = first ; begin < last ; begin += std::min(grain, last - begin) )
+		{
+			std::size_t const end = begin + std::min(grain, last - begin);
+			tasks.emplace_back(task_type([range, begin, end]
+			{
+				try
+				{
+					for( std::size_t i = begin ; i < end && !range->failed.load(std::memory_order_relaxed) ; i++ )
+					{
+						range->f(i);
+					}
+				}
+				catch(...)
+				{
+					if( !range->failed.exchange(true) )
+					{
+						range->error = std::current_exception();
+					}
+				}
+				range->chunk_done();
+			}), now);
+			if( tasks.size() == bulk_chunk )
+			{
+				enqueue_bulk(tasks);
+			}
+		}
+		enqueue_bulk(tasks);
+		return result;
+	}
+
+	/*
+	 * Own queue first, then our inbox, then steal, then the global queue. Returns false if there was
+	 * nothing to run, the caller decides whether to spin, park or do something else.
+	 */
+	bool run_pending_task() override
+	{
+		queued_task task;
+		worker_metrics& m = my_metrics();
+		task_source from;
+		if( pop_task_from_local_queue(task) )
+		{
+			m.add(m.local_pops);
+			from = task_source::own_deque;
+		}
+		else if( pop_task_from_inbox(task) )
+		{
+			m.add(m.inbox_pops);
+			from = task_source::inbox;
+		}
+		else if( pop_task_from_other_thread_queue(task) )
+		{
+			m.add(m.steals);
+			from = task_source::stolen;
+		}
+		else if( pop_task_from_pool_queue(task) )
+		{
+			m.add(m.pool_pops);
+			from = task_source::global_queue;
+		}
+		else
+		{
+			return false;
+		}
+		run_task(task, m, from);
+		return true;
+	}
+
+	/*
+	 * Record a timeline from now on, see ../24. events_per_thread sizes each worker's ring on the
+	 * first call; older events are overwritten once it is full.
+	 */
+	void start_trace(std::size_t events_per_thread = 1 << 16)
+	{
+		trace.start(events_per_thread);
+	}
+
+	void stop_trace()
+	{
+		trace.stop();
+	}
+
+	/* Chrome trace-event JSON for chrome://tracing or ui.perfetto.dev */
+	void write_trace(std::ostream& out)
+	{
+		trace.write_chrome_trace(out);
+	}
+
+	/* Per-worker counters and their total, see ../15 */
+	pool_stats stats() const
+	{
+		pool_stats s;
+		for( unsigned i = 0 ; i < queues.size() ; i++ )
+		{
+			s.workers.push_back(metrics[i].snapshot());
+			s.total.merge(s.workers.back());
+		}
+		s.external = metrics[queues.size()].snapshot();
+		s.total.merge(s.external);
+		return s;
+	}
+
+	/* Continuations (../14) are queued like any other task, on our own deque if we finished their task */
+	void schedule(scheduled_continuation* c) override
+	{
+		if( done )
+		{
+			c->abandon();
+			return;
+		}
+		enqueue(task_type(continuation_task(c)));
+	}
+
+	/* co_await pool.schedule() : the rest of the coroutine runs on one of our workers, see ../18 */
+	schedule_awaitable schedule()
+	{
+		return schedule_awaitable(this);
+	}
+
+	/*
+	 * Splitting hint for lazy binary splitting (see ../19) : true when a thief looking at the caller's
+	 * deque would find nothing, so handing off half of a range is worth it. From a thread outside
+	 * the pool it looks at the global queue instead. Approximate, like work_stealing_queue::size().
+	 */
+	bool wants_more_work() const
+	{
+		if( is_pool_thread() )
+		{
+			return local_work_queue->empty();
+		}
+		return pool_work_queue.empty();
+	}
+
+	/* One of our workers, not just any pool's */
+	bool is_pool_thread() const override
+	{
+		return local_work_queue && my_index < queues.size() && queues[my_index].get() == local_work_queue;
+	}
+};
+
+thread_local thread_pool::local_queue_type* thread_pool::local_work_queue = nullptr;
+thread_local unsigned thread_pool::my_index = 0;
+thread_local std::uint64_t thread_pool::idle_since = 0;
+thread_local unsigned thread_pool::run_depth = 0;
+
+#endif /* THREAD_POOL_CC */
@@ -0,0 +1,194 @@
+/*
+ * work_stealing_queue.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *      Pg 286 (listing 9.7), lock-free Chase-Lev version
+ *
+The queue in listing 9.7 is a std::deque<> protected by a mutex: the owner pushes and pops
+at the front, thieves take from the back. That lock is taken on every push/pop by the owner,
+even though the owner is the only thread touching its own end of the queue almost all of the
+time.
+
+This is the Chase-Lev deque ("Dynamic Circular Work-Stealing Deque", with the C11 memory
+orderings from Le, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak
+Memory Models"):
+1. Only the owner thread calls push() and try_pop(). It works at the bottom, so it sees its
+   own tasks in LIFO order (the most recently pushed task is the one whose data is still hot
+   in the cache).
+2. Any thread may call try_steal(). Thieves take from the top, so they get the oldest task,
+   which for divide-and-conquer algorithms is also the biggest chunk of work.
+3. Owner and thieves only contend when there is a single element left, and that race is
+   settled with one compare_exchange on top.
+4. The buffer is a circular array that the owner doubles when it is full. Thieves may still be
+   reading from the old array, so it is not freed until the queue itself is destroyed.
+5. Items are owned through std::unique_ptr<T, Deleter>, so the pool can keep its nodes in a
+   slab_allocator (see ../10) instead of new/delete.
+ */
+#ifndef WORK_STEALING_QUEUE_CC
+#define WORK_STEALING_QUEUE_CC
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+template<typename T, typename Deleter = std::default_delete<T>>
+class work_stealing_queue
+{
+public:
+	typedef std::unique_ptr<T, Deleter> item_ptr;
+
+private:
+	/* Circular array of pointers. Slots are atomic because a thief may read a slot while the owner writes it */
+	struct circular_array
+	{
+		std::int64_t const size;
+		std::int64_t const mask;
+		std::unique_ptr<std::atomic<T*>[]> slots;
+
+		explicit circular_array(std::int64_t size_) : size(size_), mask(size_-1), slots(new std::atomic<T*>[size_])
+		{}
+
+		T* get(std::int64_t i) const
+		{
+			return slots[i & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(std::int64_t i, T* item)
+		{
+			slots[i & mask].store(item, std::memory_order_relaxed);
+		}
+
+		/* Copy live elements [top, bottom) into an array twice the size */
+		circular_array* grow(std::int64_t bottom, std::int64_t top) const
+		{
+			circular_array* const bigger = new circular_array(size*2);
+			for( std::int64_t i = top ; i < bottom ; i++ )
+			{
+				bigger->put(i, get(i));
+			}
+			return bigger;
+		}
+	};
+
+	/*
+	 * top is written by thieves and bottom only by the owner, keep them on separate cache lines so
+	 * that a steal does not invalidate the owner's line on every push/pop.
+	 */
+	alignas(64) std::atomic<std::int64_t> top;
+	alignas(64) std::atomic<std::int64_t> bottom;
+	alignas(64) std::atomic<circular_array*> array;
+
+	/* Arrays replaced by grow(), kept alive because a thief may still hold a pointer to them (owner only) */
+	std::vector<std::unique_ptr<circular_array>> retired;
+
+public:
+	explicit work_stealing_queue(std::int64_t initial_size = 1024) : top(0), bottom(0),
+																	 array(new circular_array(initial_size))
+	{}
+
+	work_stealing_queue(const work_stealing_queue& other) = delete;
+	work_stealing_queue& operator = (const work_stealing_queue& other) = delete;
+
+	~work_stealing_queue()
+	{
+		/* Queue owns the items still in it */
+		item_ptr item;
+		while( (item = try_pop()) )
+		{}
+		delete array.load(std::memory_order_relaxed);
+	}
+
+	/* Owner only : push a task at the bottom */
+	void push(item_ptr item)
+	{
+		std::int64_t const b = bottom.load(std::memory_order_relaxed);
+		std::int64_t const t = top.load(std::memory_order_acquire);
+		circular_array* a = array.load(std::memory_order_relaxed);
+
+		if( b - t > a->size - 1 )
+		{
+			retired.emplace_back(a);
+			a = a->grow(b, t);
+			array.store(a, std::memory_order_release);
+		}
+
+		a->put(b, item.release());
+
+		/* Release : publish the slot before the new bottom becomes visible to thieves */
+		bottom.store(b+1, std::memory_order_release);
+	}
+
+	/* Owner only : pop the most recently pushed task (LIFO), empty pointer if there is none */
+	item_ptr try_pop()
+	{
+		std::int64_t const b = bottom.load(std::memory_order_relaxed) - 1;
+		circular_array* const a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+
+		/*
+		 * The seq_cst fence orders the store to bottom before the load of top, so either we see the
+		 * thief's increment of top, or the thief sees our decrement of bottom.
+		 */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+
+		if( t > b )
+		{
+			// Queue was empty, restore bottom
+			bottom.store(b+1, std::memory_order_relaxed);
+			return item_ptr();
+		}
+
+		T* item = a->get(b);
+		if( t == b )
+		{
+			/* Last element : race against thieves for it by advancing top */
+			if( !top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed) )
+			{
+				item = nullptr;		// a thief won
+			}
+			bottom.store(b+1, std::memory_order_relaxed);
+		}
+		return item_ptr(item);
+	}
+
+	/* Any thread : steal the oldest task (FIFO), empty pointer if the queue is empty or we lost a race */
+	item_ptr try_steal()
+	{
+		std::int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t const b = bottom.load(std::memory_order_acquire);
+
+		if( t >= b )
+		{
+			return item_ptr();
+		}
+
+		circular_array* const a = array.load(std::memory_order_acquire);
+		T* const item = a->get(t);
+		if( !top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed) )
+		{
+			// Another thief or the owner took it first
+			return item_ptr();
+		}
+		return item_ptr(item);
+	}
+
+	/* Approximate, only meaningful as a hint */
+	bool empty() const
+	{
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+	/* Approximate as well, for sampling the queue depth */
+	std::size_t size() const
+	{
+		std::int64_t const n = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+		return n > 0 ? static_cast<std::size_t>(n) : 0;
+	}
+};
+
+#endif /* WORK_STEALING_QUEUE_CC */
@@ -0,0 +1,65 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Measures what an idle pool costs and how fast a parked worker wakes up, using the work-stealing
+ * pool from ../6 with different idle_options :
+ * 1. CPU time (user + sys) burnt by the whole process while the pool sits idle for one second.
+ * 2. Latency from submit() to the task starting, when the workers have been idle long enough to park.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+double process_cpu_seconds()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+		   usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+void measure(char const* name, idle_options idle)
+{
+	thread_pool pool(std::max(std::thread::hardware_concurrency(), 1u), idle);
+
+	/* Idle CPU : let the pool settle, then see how much CPU one second of doing nothing costs */
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	double const cpu_before = process_cpu_seconds();
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	double const idle_cpu = process_cpu_seconds() - cpu_before;
+
+	/* Wake-up latency : submit from outside the pool after the workers had time to park */
+	std::vector<double> latencies;
+	for( unsigned i = 0 ; i < 200 ; i++ )
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		clock_type::time_point const submitted = clock_type::now();
+		clock_type::time_point const started = pool.submit([] { return clock_type::now(); }).get();
+		latencies.push_back(std::chrono::duration<double, std::micro>(started - submitted).count());
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	std::cout << name << " : idle cpu " << idle_cpu * 100 << "% of one core, wake latency p50 "
+			  << latencies[latencies.size()/2] << " us, p99 " << latencies[latencies.size()*99/100]
+			  << " us" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	/* Huge spin/yield counts never reach the park stage, this is the old behaviour */
+	measure("spin only   ", idle_options(~0u / 2, ~0u / 2));
+	measure("spin + park ", idle_options());
+	measure("park at once", idle_options(0, 0));
+	return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * eventcount.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+Every worker_thread() in the earlier pools does try_pop() and then std::this_thread::yield() in a
+tight loop. yield() only gives the core away if some other thread wants it, so an idle pool keeps
+every core at 100%.
+
+An idle worker now goes through three stages:
+1. Spin : retry try_pop() a few times with a cpu pause instruction in between. Work that arrives
+   within a few hundred nanoseconds is picked up without any system call.
+2. Yield : retry a few more times with yield(), as before.
+3. Park : sleep on an eventcount until submit() signals that there is new work.
+
+An eventcount is a condition variable for lock-free code. There is no mutex to close the race
+between "queue is empty" and "go to sleep", so waiting is split into steps:
+	key = prepare_wait();		// announce that we are about to sleep
+	if( work available )		// re-check after announcing
+		cancel_wait();
+	else
+		commit_wait(key);		// sleep, unless notify() ran since prepare_wait()
+A notifier that pushes work and then finds waiters == 0 knows that any later waiter will see that
+work in its re-check, so submit() only pays for a futex wake when somebody is actually asleep.
+Sleeping and waking use std::atomic<>::wait()/notify_one() (C++20), which is a futex on Linux.
+
+Build with -std=c++20.
+ */
+#ifndef EVENTCOUNT_CC
+#define EVENTCOUNT_CC
+
+#include <atomic>
+#include <thread>
+
+/* Tell the cpu we are in a spin-wait loop (cheaper for the sibling hyperthread, faster loop exit) */
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+class eventcount
+{
+	std::atomic<unsigned> epoch;		// bumped by every notify that finds a waiter
+	std::atomic<unsigned> waiters;		// threads between prepare_wait() and the end of their wait
+
+public:
+	eventcount() : epoch(0), waiters(0)
+	{}
+
+	eventcount(const eventcount&) = delete;
+	eventcount& operator = (const eventcount&) = delete;
+
+	/* Step 1 : register as a waiter and return the key to pass to commit_wait() */
+	unsigned prepare_wait()
+	{
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		/* Pairs with the fence in notify : either we see the new work, or the notifier sees us */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return epoch.load(std::memory_order_acquire);
+	}
+
+	/* Step 2a : the re-check found work, don't sleep */
+	void cancel_wait()
+	{
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/* Step 2b : sleep until the epoch moves past key. Returns at once if a notify already happened */
+	void commit_wait(unsigned key)
+	{
+		epoch.wait(key, std::memory_order_acquire);
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/* Park until condition() holds. Same shape as std::condition_variable::wait(lock, pred) */
+	template<typename Predicate>
+	void wait(Predicate condition)
+	{
+		while( !condition() )
+		{
+			unsigned const key = prepare_wait();
+			if( condition() )
+			{
+				cancel_wait();
+				return;
+			}
+			commit_wait(key);
+		}
+	}
+
+	/* Call after publishing work. Costs a fence and a load when nobody is asleep */
+	void notify_one()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if( waiters.load(std::memory_order_relaxed) )
+		{
+			epoch.fetch_add(1, std::memory_order_release);
+			epoch.notify_one();
+		}
+	}
+
+	void notify_all()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if( waiters.load(std::memory_order_relaxed) )
+		{
+			epoch.fetch_add(1, std::memory_order_release);
+			epoch.notify_all();
+		}
+	}
+};
+
+/* How long an idle worker keeps looking for work before it parks */
+struct idle_options
+{
+	unsigned spin_count;		// polls with cpu_relax() in between
+	unsigned yield_count;		// further polls with std::this_thread::yield() in between
+
+	idle_options(unsigned spin_count_ = 128, unsigned yield_count_ = 8) :
+		spin_count(spin_count_), yield_count(yield_count_)
+	{}
+};
+
+/*
+ * Per-worker backoff state. backoff() pauses for one round and returns true while the worker should
+ * keep polling, and returns false when it is time to park.
+ */
+class idle_backoff
+{
+	idle_options const options;
+	unsigned rounds;
+
+public:
+	explicit idle_backoff(idle_options const& options_) : options(options_), rounds(0)
+	{}
+
+	bool backoff()
+	{
+		if( rounds < options.spin_count )
+		{
+			cpu_relax();
+		}
+		else if( rounds < options.spin_count + options.yield_count )
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			return false;
+		}
+		++rounds;
+		return true;
+	}
+
+	void reset()
+	{
+		rounds = 0;
+	}
+};
+
+#endif /* EVENTCOUNT_CC */
@@ -0,0 +1,196 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * Benchmark of the inline-storage function_wrapper against the original virtual/heap version from
+ * ../2 and against std::function<void()>. Each round wraps N tasks, moves them through a queue the
+ * way a pool does, then pops and runs them. Global operator new is counted so the allocations per
+ * task show up next to the time (the std::deque's own blocks account for 0.125 allocations/task).
+ *
+ * Build : g++ -std=c++17 -O2 demo.cc -o demo
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <new>
+#include "function_wrapper.cc"
+
+static std::atomic<unsigned long> allocation_count(0);
+
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if( void* p = std::malloc(size ? size : 1) )
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+/* Copy of : ../2 A thread pool with waitable tasks/demo.cc, renamed */
+class virtual_function_wrapper
+{
+	struct impl_base
+	{
+		virtual void call() = 0;
+		virtual ~impl_base() {}
+	};
+
+	std::unique_ptr<impl_base> impl;
+	template<typename F>
+	struct impl_type : impl_base
+	{
+		F f;
+		impl_type(F&& f_) : f(std::move(f_)) {}
+		void call()
+		{
+			f();
+		}
+	};
+
+public:
+
+	template<typename F>
+	virtual_function_wrapper(F&& f ) : impl(new impl_type<F>(std::move(f)))
+	{}
+
+	void operator () ()
+	{
+		impl->call();
+	}
+
+	virtual_function_wrapper() = default;
+
+	virtual_function_wrapper(virtual_function_wrapper&& other) : impl(std::move(other.impl))
+	{}
+
+	virtual_function_wrapper& operator = (virtual_function_wrapper&& other)
+	{
+		impl = std::move(other.impl);
+		return *this;
+	}
+
+	virtual_function_wrapper(const virtual_function_wrapper&) = delete;
+	virtual_function_wrapper(virtual_function_wrapper&) = delete;
+	virtual_function_wrapper& operator = (const virtual_function_wrapper&) = delete;
+};
+
+/* Small task : three words of captures, the size of a typical parallel_accumulate block */
+struct small_task
+{
+	unsigned long* sink;
+	unsigned long a, b;
+	void operator()() { *sink += a + b; }
+};
+
+/* Large task : too big for any small buffer, takes the heap fallback */
+struct large_task
+{
+	unsigned long* sink;
+	unsigned long values[16];
+	void operator()() { *sink += values[0] + values[15]; }
+};
+
+template<typename Wrapper, typename Task>
+void run(char const* name, unsigned long count)
+{
+	unsigned long sink = 0;
+	std::deque<Wrapper> queue;
+
+	unsigned long const allocations_before = allocation_count.load();
+	auto const start = std::chrono::steady_clock::now();
+
+	for( unsigned long round = 0 ; round < 10 ; round++ )
+	{
+		for( unsigned long i = 0 ; i < count ; i++ )
+		{
+			Task task = Task();
+			task.sink = &sink;
+			queue.push_back(Wrapper(std::move(task)));
+		}
+		while( !queue.empty() )
+		{
+			Wrapper w(std::move(queue.front()));
+			queue.pop_front();
+			w();
+		}
+	}
+
+	auto const stop = std::chrono::steady_clock::now();
+	double const tasks = count * 10.0;
+	std::cout << name << " : " << std::chrono::duration<double, std::nano>(stop - start).count() / tasks
+			  << " ns/task, " << (allocation_count.load() - allocations_before) / tasks << " allocations/task"
+			  << (sink == ~0ul ? "!" : "") << std::endl;
+}
+
+/* std::function<> cannot hold a move-only std::packaged_task<>, so only the two wrappers run this case */
+template<typename Wrapper>
+void run_packaged_task(char const* name, unsigned long count)
+{
+	std::deque<Wrapper> queue;
+	std::deque<std::future<int>> futures;
+
+	unsigned long const allocations_before = allocation_count.load();
+	auto const start = std::chrono::steady_clock::now();
+
+	for( unsigned long i = 0 ; i < count ; i++ )
+	{
+		std::packaged_task<int()> task([i] { return static_cast<int>(i); });
+		futures.push_back(task.get_future());
+		queue.push_back(Wrapper(std::move(task)));
+	}
+	while( !queue.empty() )
+	{
+		Wrapper w(std::move(queue.front()));
+		queue.pop_front();
+		w();
+	}
+	long sum = 0;
+	for( unsigned long i = 0 ; i < futures.size() ; i++ )
+	{
+		sum += futures[i].get();
+	}
+
+	auto const stop = std::chrono::steady_clock::now();
+	std::cout << name << " : " << std::chrono::duration<double, std::nano>(stop - start).count() / count
+			  << " ns/task, " << (allocation_count.load() - allocations_before) / double(count)
+			  << " allocations/task" << (sum < 0 ? "!" : "") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const count = argc > 1 ? std::atol(argv[1]) : 100000;
+
+	std::cout << "sizeof(function_wrapper) = " << sizeof(function_wrapper) << std::endl;
+
+	run<virtual_function_wrapper, small_task>("small, virtual_function_wrapper", count);
+	run<std::function<void()>, small_task>   ("small, std::function          ", count);
+	run<function_wrapper, small_task>        ("small, function_wrapper       ", count);
+
+	run<virtual_function_wrapper, large_task>("large, virtual_function_wrapper", count);
+	run<std::function<void()>, large_task>   ("large, std::function          ", count);
+	run<function_wrapper, large_task>        ("large, function_wrapper       ", count);
+
+	/* What submit() actually queues : the packaged_task's own shared state is allocated either way */
+	run_packaged_task<virtual_function_wrapper>("packaged_task, virtual_function_wrapper", count);
+	run_packaged_task<function_wrapper>        ("packaged_task, function_wrapper       ", count);
+	return 0;
+}
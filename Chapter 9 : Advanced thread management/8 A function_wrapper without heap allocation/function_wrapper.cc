@@ -0,0 +1,184 @@
+/*
+ * function_wrapper.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+The function_wrapper from ../2 allocates an impl_type<F> with new for every task and calls it
+through a virtual function. For a pool running millions of tiny tasks a second, that new/delete
+pair costs more than the task itself.
+
+This version keeps small callables inside the wrapper :
+1. 48 bytes of inline storage, so the whole wrapper is 64 bytes, one cache line. A
+   std::packaged_task<> (one shared_ptr) or a lambda capturing a few pointers fits easily.
+2. Callables that are too big, over-aligned, or could throw while being moved go on the heap as
+   before, so anything still works.
+3. Instead of a virtual base class there is a hand-rolled vtable : a static table of three
+   function pointers (call, move, destroy) per callable type. The wrapper holds a pointer to it,
+   and a null pointer means empty.
+4. Like the original it is move-only, so it can hold std::packaged_task<>.
+ */
+#ifndef FUNCTION_WRAPPER_CC
+#define FUNCTION_WRAPPER_CC
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+class function_wrapper
+{
+	static std::size_t const inline_size = 48;
+	typedef typename std::aligned_storage<inline_size, alignof(std::max_align_t)>::type storage_type;
+
+	struct vtable
+	{
+		void (*call)(storage_type& self);
+		void (*move)(storage_type& to, storage_type& from);		// leaves from destroyed
+		void (*destroy)(storage_type& self);
+	};
+
+	/* Callable constructed in place inside storage */
+	template<typename F>
+	struct inline_ops
+	{
+		static F& get(storage_type& s)
+		{
+			return *std::launder(reinterpret_cast<F*>(&s));
+		}
+		static void call(storage_type& self)
+		{
+			get(self)();
+		}
+		static void move(storage_type& to, storage_type& from)
+		{
+			::new (static_cast<void*>(&to)) F(std::move(get(from)));
+			get(from).~F();
+		}
+		static void destroy(storage_type& self)
+		{
+			get(self).~F();
+		}
+	};
+
+	/* Callable on the heap, storage only holds the pointer */
+	template<typename F>
+	struct heap_ops
+	{
+		static F*& get(storage_type& s)
+		{
+			return *std::launder(reinterpret_cast<F**>(&s));
+		}
+		static void call(storage_type& self)
+		{
+			(*get(self))();
+		}
+		static void move(storage_type& to, storage_type& from)
+		{
+			::new (static_cast<void*>(&to)) F*(get(from));
+		}
+		static void destroy(storage_type& self)
+		{
+			delete get(self);
+		}
+	};
+
+	template<typename F>
+	struct fits_inline : std::integral_constant<bool,
+										sizeof(F) <= inline_size &&
+										alignof(std::max_align_t) % alignof(F) == 0 &&
+										std::is_nothrow_move_constructible<F>::value>
+	{};
+
+	template<typename Ops>
+	static vtable const* table_for()
+	{
+		static vtable const table = { &Ops::call, &Ops::move, &Ops::destroy };
+		return &table;
+	}
+
+	storage_type storage;
+	vtable const* ops;
+
+	void reset()
+	{
+		if( ops )
+		{
+			ops->destroy(storage);
+			ops = nullptr;
+		}
+	}
+
+	template<typename F>
+	void construct(F&& f, std::true_type /* fits inline */)
+	{
+		typedef typename std::decay<F>::type functor_type;
+		::new (static_cast<void*>(&storage)) functor_type(std::forward<F>(f));
+		ops = table_for<inline_ops<functor_type>>();
+	}
+
+	template<typename F>
+	void construct(F&& f, std::false_type /* fits inline */)
+	{
+		typedef typename std::decay<F>::type functor_type;
+		::new (static_cast<void*>(&storage)) functor_type*(new functor_type(std::forward<F>(f)));
+		ops = table_for<heap_ops<functor_type>>();
+	}
+
+public:
+	function_wrapper() : ops(nullptr)
+	{}
+
+	template<typename F, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<F>::type, function_wrapper>::value>::type>
+	function_wrapper(F&& f) : ops(nullptr)
+	{
+		construct(std::forward<F>(f), fits_inline<typename std::decay<F>::type>());
+	}
+
+	~function_wrapper()
+	{
+		reset();
+	}
+
+	/* Overload () operator */
+	void operator () ()
+	{
+		ops->call(storage);
+	}
+
+	explicit operator bool() const
+	{
+		return ops != nullptr;
+	}
+
+	function_wrapper(function_wrapper&& other) noexcept : ops(other.ops)
+	{
+		if( ops )
+		{
+			ops->move(storage, other.storage);
+			other.ops = nullptr;
+		}
+	}
+
+	function_wrapper& operator = (function_wrapper&& other) noexcept
+	{
+		if( this != &other )
+		{
+			reset();
+			if( other.ops )
+			{
+				other.ops->move(storage, other.storage);
+				ops = other.ops;
+				other.ops = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	function_wrapper(const function_wrapper&) = delete;
+	function_wrapper(function_wrapper&) = delete;
+	function_wrapper& operator = (const function_wrapper&) = delete;
+};
+
+#endif /* FUNCTION_WRAPPER_CC */
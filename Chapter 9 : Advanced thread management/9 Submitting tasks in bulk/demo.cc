@@ -0,0 +1,136 @@
+/*
+ * demo.cc
+ *
+ *  Created on: 17-Oct-2026
+ *      Author: prateek
+ *
+ * parallel_accumulate from ../3 submits num_blocks-1 tasks one submit() at a time, so every block
+ * takes the pool_work_queue lock once. With 10k+ blocks the submitting thread spends its time on that
+ * lock while the workers fight it for the same mutex to pop.
+ *
+ * The work-stealing pool in ../6 has two bulk calls :
+ * 1. submit_bulk(first, last) : one task per callable, enqueued in one go with a single wake-up, one
+ *    task_handle<> per task as before. (pool_work_queue has since become lock-free, see ../22.)
+ * 2. submit_range(first, last, f, grain) : f(i) for every index, grain indices per task, and a single
+ *    task_handle<void> for the whole range, so there is no shared state per task at all.
+ *
+ * The benchmark below sums the same vector three ways with the same block size.
+ *
+ * Build : g++ -std=c++20 -O2 demo.cc -o demo -lpthread
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include "../6 A thread pool that uses work stealing/thread_pool.cc"
+
+typedef std::chrono::steady_clock clock_type;
+
+template<typename Iterator, typename T>
+struct accumulate_block
+{
+	Iterator first, last;
+	T operator()()
+	{
+		return std::accumulate(first, last, T());
+	}
+};
+
+/* As ../3 : one submit() per block */
+template<typename Iterator, typename T>
+T accumulate_one_by_one(thread_pool& pool, Iterator first, Iterator last, T init, unsigned long block_size)
+{
+	unsigned long const length = std::distance(first, last);
+	unsigned long const num_blocks = (length + block_size - 1) / block_size;
+
+	std::vector<task_handle<T>> handles;
+	handles.reserve(num_blocks);
+	for( Iterator block_start = first ; block_start != last ; )
+	{
+		Iterator block_end = block_start;
+		std::advance(block_end, std::min<unsigned long>(block_size, std::distance(block_start, last)));
+		handles.push_back(pool.submit(accumulate_block<Iterator, T>{block_start, block_end}));
+		block_start = block_end;
+	}
+
+	T result = init;
+	for( unsigned long i = 0 ; i < handles.size() ; i++ )
+	{
+		result += handles[i].get();
+	}
+	return result;
+}
+
+/* All the blocks in one submit_bulk() call */
+template<typename Iterator, typename T>
+T accumulate_bulk(thread_pool& pool, Iterator first, Iterator last, T init, unsigned long block_size)
+{
+	std::vector<accumulate_block<Iterator, T>> blocks;
+	blocks.reserve((std::distance(first, last) + block_size - 1) / block_size);
+	for( Iterator block_start = first ; block_start != last ; )
+	{
+		Iterator block_end = block_start;
+		std::advance(block_end, std::min<unsigned long>(block_size, std::distance(block_start, last)));
+		blocks.push_back(accumulate_block<Iterator, T>{block_start, block_end});
+		block_start = block_end;
+	}
+
+	std::vector<task_handle<T>> handles = pool.submit_bulk(blocks.begin(), blocks.end());
+
+	T result = init;
+	for( unsigned long i = 0 ; i < handles.size() ; i++ )
+	{
+		result += handles[i].get();
+	}
+	return result;
+}
+
+/* submit_range() over the block indices, each block writes its partial sum into its own slot */
+template<typename Iterator, typename T>
+T accumulate_range(thread_pool& pool, Iterator first, Iterator last, T init, unsigned long block_size)
+{
+	unsigned long const length = std::distance(first, last);
+	unsigned long const num_blocks = (length + block_size - 1) / block_size;
+	std::vector<T> partial(num_blocks);
+
+	pool.submit_range(0, num_blocks, [&](std::size_t block)
+	{
+		Iterator block_start = first;
+		std::advance(block_start, block * block_size);
+		Iterator block_end = block_start;
+		std::advance(block_end, std::min<unsigned long>(block_size, length - block * block_size));
+		partial[block] = std::accumulate(block_start, block_end, T());
+	}).get();
+
+	return std::accumulate(partial.begin(), partial.end(), init);
+}
+
+template<typename Function>
+void time_it(char const* name, Function f, long expected)
+{
+	clock_type::time_point const start = clock_type::now();
+	long const result = f();
+	clock_type::time_point const stop = clock_type::now();
+	std::cout << name << " : " << std::chrono::duration<double, std::milli>(stop - start).count() << " ms"
+			  << (result == expected ? "" : " WRONG RESULT") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long const length = argc > 1 ? std::atol(argv[1]) : 1000000;
+	unsigned long const block_size = argc > 2 ? std::atol(argv[2]) : 25;
+
+	std::vector<long> data(length);
+	std::iota(data.begin(), data.end(), 0);
+	long const expected = std::accumulate(data.begin(), data.end(), 0l);
+
+	thread_pool pool;
+	std::cout << (length + block_size - 1) / block_size << " blocks of " << block_size << std::endl;
+
+	time_it("submit() per block", [&] { return accumulate_one_by_one(pool, data.begin(), data.end(), 0l, block_size); }, expected);
+	time_it("submit_bulk()     ", [&] { return accumulate_bulk(pool, data.begin(), data.end(), 0l, block_size); }, expected);
+	time_it("submit_range()    ", [&] { return accumulate_range(pool, data.begin(), data.end(), 0l, block_size); }, expected);
+	return 0;
+}